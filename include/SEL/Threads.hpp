@@ -1,5 +1,28 @@
 // Include all the Thread headers 
 
 #include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Backoff.hpp"
+#include "SEL/Threads/FutexMutex.hpp"
+#include "SEL/Threads/SeqLock.hpp"
+#include "SEL/Threads/DistributedSharedMutex.hpp"
+#include "SEL/Threads/ShardedCounter.hpp"
+#include "SEL/Threads/EpochDomain.hpp"
+#include "SEL/Threads/ConcurrentHashMap.hpp"
+#include "SEL/Threads/Snapshot.hpp"
+#include "SEL/Threads/TripleBuffer.hpp"
+#include "SEL/Threads/Affinity.hpp"
 #include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/Heartbeat.hpp"
 #include "SEL/Threads/LoopThread.hpp"
+#include "SEL/Threads/Barrier.hpp"
+#include "SEL/Threads/LoopThreadGroup.hpp"
+#include "SEL/Threads/SpscRingBuffer.hpp"
+#include "SEL/Threads/MpmcQueue.hpp"
+#include "SEL/Threads/Pipeline.hpp"
+#include "SEL/Threads/WorkStealingDeque.hpp"
+#include "SEL/Threads/ThreadPool.hpp"
+#include "SEL/Threads/Watchdog.hpp"
+#include "SEL/Threads/Parallel.hpp"
+#include "SEL/Threads/TaskGraph.hpp"
+#include "SEL/Threads/PeriodicScheduler.hpp"
+#include "SEL/Threads/Task.hpp"
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+	#include <pthread.h>
+	#include <sched.h>
+	#include <unistd.h>
+#endif
+
+
+namespace sel {
+
+	namespace utils {
+
+		// Native thread controls. They are only implemented on Linux and return false elsewhere.
+
+		inline bool setNativeAffinity(std::thread::native_handle_type handle, const std::vector<unsigned int>& cpus)
+		{
+#ifdef __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+
+			for (unsigned int cpu : cpus)
+			{
+				if (cpu >= CPU_SETSIZE)
+					return false;
+
+				CPU_SET(cpu, &set);
+			}
+
+			return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+#else
+			(void)handle;
+			(void)cpus;
+			return false;
+#endif
+		}
+
+		/// Logical CPUs the calling thread may run on, which the threads it creates inherit. Empty if they cannot be read.
+		inline std::vector<unsigned int> getAllowedCpus()
+		{
+			std::vector<unsigned int> cpus;
+
+#ifdef __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+
+			if (sched_getaffinity(0, sizeof(set), &set) == 0)
+			{
+				for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				{
+					if (CPU_ISSET(cpu, &set))
+						cpus.push_back(cpu);
+				}
+			}
+#endif
+
+			return cpus;
+		}
+
+		inline bool setNativeName(std::thread::native_handle_type handle, const std::string& name)
+		{
+#ifdef __linux__
+			// Linux limits names to 15 characters plus the terminating null character.
+			return pthread_setname_np(handle, name.substr(0, 15).c_str()) == 0;
+#else
+			(void)handle;
+			(void)name;
+			return false;
+#endif
+		}
+
+		inline bool setNativeScheduling(std::thread::native_handle_type handle, int policy, int priority)
+		{
+#ifdef __linux__
+			sched_param parameters{};
+			parameters.sched_priority = priority;
+
+			return pthread_setschedparam(handle, policy, &parameters) == 0;
+#else
+			(void)handle;
+			(void)policy;
+			(void)priority;
+			return false;
+#endif
+		}
+
+	}
+
+
+	/// @brief Lists the logical CPUs of the machine, one per physical core first.
+	///
+	/// The first logical CPU of every physical core comes first, then the second hardware thread of every core, and so on.
+	/// Taking the beginning of the list thus avoids putting two threads on SMT siblings.
+	/// Only the CPUs the calling thread is allowed to run on are listed, so that pinning to them succeeds in a container or under taskset.
+	/// Topology is only read on Linux. Elsewhere, or if it cannot be read, every logical CPU is assumed to be its own core.
+	///
+	/// @return The identifiers of the logical CPUs.
+	///
+	inline std::vector<unsigned int> getCpusByPhysicalCore()
+	{
+		std::vector<unsigned int> cpus;
+
+#ifdef __linux__
+		struct CpuTopology
+		{
+			int package;
+			int core;
+			unsigned int cpu;
+		};
+
+		std::vector<CpuTopology> topology;
+		std::vector<unsigned int> allowed = utils::getAllowedCpus();
+		long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+
+		for (long cpu = 0; cpu < cpuCount; cpu++)
+		{
+			if (!allowed.empty() && !std::binary_search(allowed.begin(), allowed.end(), static_cast<unsigned int>(cpu)))
+				continue;
+
+			std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+			std::ifstream coreFile(path + "core_id");
+			std::ifstream packageFile(path + "physical_package_id");
+			CpuTopology entry{ 0, 0, static_cast<unsigned int>(cpu) };
+
+			// Offline CPUs have no topology.
+			if (coreFile >> entry.core && packageFile >> entry.package)
+				topology.push_back(entry);
+		}
+
+		// Hardware threads of a same core get consecutive ranks, which are then used to interleave the cores.
+		std::sort(topology.begin(), topology.end(), [](const CpuTopology& a, const CpuTopology& b) {
+			return std::tie(a.package, a.core, a.cpu) < std::tie(b.package, b.core, b.cpu);
+		});
+
+		std::vector<std::pair<unsigned int, unsigned int>> ranked;
+
+		for (std::size_t i = 0; i < topology.size(); i++)
+		{
+			bool sameCore = i > 0 && topology[i].package == topology[i - 1].package && topology[i].core == topology[i - 1].core;
+			unsigned int rank = sameCore ? ranked.back().first + 1 : 0;
+
+			ranked.emplace_back(rank, topology[i].cpu);
+		}
+
+		std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		for (const auto& entry : ranked)
+			cpus.push_back(entry.second);
+#endif
+
+		if (cpus.empty())
+			cpus = utils::getAllowedCpus();
+
+		if (cpus.empty())
+		{
+			unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+
+			for (unsigned int cpu = 0; cpu < count; cpu++)
+				cpus.push_back(cpu);
+		}
+
+		return cpus;
+	}
+
+	/// @brief Chooses a logical CPU for each of the given number of workers, spreading them across physical cores.
+	///
+	/// Workers are assigned a distinct physical core as long as there are enough of them. SMT siblings are only used
+	/// once every physical core has a worker, and CPUs are reused once every logical CPU has one.
+	///
+	/// @param workerCount is the number of workers.
+	///
+	/// @return The logical CPU of each worker.
+	///
+	inline std::vector<unsigned int> spreadOverPhysicalCores(std::size_t workerCount)
+	{
+		std::vector<unsigned int> cpus = getCpusByPhysicalCore();
+		std::vector<unsigned int> assigned;
+
+		assigned.reserve(workerCount);
+
+		for (std::size_t i = 0; i < workerCount; i++)
+			assigned.push_back(cpus[i % cpus.size()]);
+
+		return assigned;
+	}
+
+}
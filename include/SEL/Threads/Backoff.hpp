@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#include <immintrin.h>
+#endif
+
+
+namespace sel {
+
+	namespace utils {
+
+		/// Tells the CPU the thread is spinning, which saves power and frees resources for its SMT sibling.
+		inline void cpuRelax()
+		{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+			_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			asm volatile("yield");
+#endif
+		}
+
+	}
+
+
+	/// @brief Waiting policy for polling loops that escalates from spinning to yielding to sleeping.
+	///
+	/// Each call to pause() waits a bit longer than the previous one:
+	/// - First, the thread spins with CPU pause instructions, twice as many at each step. This reacts the fastest.
+	/// - Then, it yields to the other threads, which still keeps a core busy if nothing else runs.
+	/// - Finally, it sleeps, twice as long at each step up to a maximum. This frees the core but wakes up late.
+	///
+	/// The thresholds trade wake-up latency against CPU usage. Call reset() once the awaited condition is met
+	/// to start from the spinning phase again.
+	///
+	class Backoff
+	{
+	public:
+
+		/// @brief Value of the yield count to never start sleeping.
+		///
+		static constexpr unsigned int neverSleep = std::numeric_limits<unsigned int>::max();
+
+
+		/// @brief Constructor.
+		///
+		/// @param spinCount is the number of steps spent spinning. Step i executes 2^i pause instructions.
+		/// @param yieldCount is the number of steps spent yielding after spinning. If neverSleep, the thread never sleeps.
+		/// @param minSleep is the duration of the first sleep.
+		/// @param maxSleep is the longest duration of a sleep.
+		///
+		explicit Backoff(unsigned int spinCount = 6, unsigned int yieldCount = 64,
+			std::chrono::nanoseconds minSleep = std::chrono::microseconds(50), std::chrono::nanoseconds maxSleep = std::chrono::milliseconds(1))
+			: m_spinCount(spinCount), m_yieldCount(yieldCount), m_minSleep(minSleep), m_maxSleep(maxSleep)
+		{
+			reset();
+		}
+
+
+		/// @brief Waits once, longer than the previous time.
+		///
+		void pause()
+		{
+			pause(m_maxSleep);
+		}
+
+		/// @brief Waits once, longer than the previous time, without sleeping more than the given duration.
+		///
+		/// This allows a deadline to be waited for without oversleeping it too much.
+		///
+		/// @param maxSleep is the longest duration the call may sleep.
+		///
+		void pause(std::chrono::nanoseconds maxSleep)
+		{
+			if (m_step < m_spinCount)
+			{
+				for (unsigned int i = 0, count = 1u << std::min(m_step, 16u); i < count; i++)
+					utils::cpuRelax();
+
+				m_step++;
+			}
+			else if (m_yieldCount == neverSleep || m_step - m_spinCount < m_yieldCount)
+			{
+				std::this_thread::yield();
+
+				if (m_yieldCount != neverSleep)
+					m_step++;
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::min(m_sleep, maxSleep));
+				m_sleep = std::min(m_sleep * 2, m_maxSleep);
+			}
+		}
+
+		/// @brief Starts from the spinning phase again.
+		///
+		void reset()
+		{
+			m_step = 0;
+			m_sleep = m_minSleep;
+		}
+
+
+		/// @return The value indicating if the next call to pause() will sleep.
+		///
+		bool isSleeping() const
+		{
+			return m_yieldCount != neverSleep && m_step >= m_spinCount + m_yieldCount;
+		}
+
+
+	private:
+
+		unsigned int m_spinCount;
+		unsigned int m_yieldCount;
+		std::chrono::nanoseconds m_minSleep;
+		std::chrono::nanoseconds m_maxSleep;
+
+		unsigned int m_step;
+		std::chrono::nanoseconds m_sleep;
+	};
+
+
+	/// @brief Blocks the thread until the given predicate returns true, waiting with a Backoff in between.
+	///
+	/// @tparam Predicate is a callable type returning a bool.
+	/// @param predicate is the awaited condition.
+	/// @param backoff is the waiting policy.
+	///
+	template <class Predicate>
+	void waitFor(Predicate&& predicate, Backoff backoff = Backoff())
+	{
+		while (!predicate())
+			backoff.pause();
+	}
+
+
+	/// @brief Blocks the thread until the given condition is fulfilled, spinning, yielding then sleeping in between.
+	///
+	#define WAIT_FOR_BACKOFF(condition) ::sel::waitFor([&] { return static_cast<bool>(condition); })
+
+}
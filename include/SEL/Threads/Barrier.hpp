@@ -0,0 +1,124 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Backoff.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+
+namespace sel {
+
+	/// @brief Reusable barrier making a fixed number of threads wait for each other.
+	///
+	/// This is a sense-reversing barrier: each thread remembers the sense of the phase it arrives in and
+	/// waits for the last thread to flip it, so the barrier can be reused right away without any reset.
+	/// Waiting threads poll with a Backoff for a short while, then park until the phase is over. The barrier never allocates.
+	///
+	class Barrier : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param threadCount is the number of threads that must arrive before any of them is released. It must not be 0.
+		///
+		explicit Barrier(std::size_t threadCount)
+			: m_threadCount(threadCount), m_remaining(threadCount) {}
+
+
+		/// @brief Waits for every thread to arrive.
+		///
+		/// @return The value indicating if the calling thread was the last one to arrive. Exactly one thread gets true per phase.
+		///
+		bool arriveAndWait()
+		{
+			return arriveAndWait([] {});
+		}
+
+		/// @brief Waits for every thread to arrive, running a function before they are released.
+		///
+		/// The function is run by the last thread to arrive, while all the others are still waiting.
+		/// What it writes is visible to every thread once they are released.
+		///
+		/// @tparam Fn is a callable type.
+		/// @param completion is the function run once per phase.
+		///
+		/// @return The value indicating if the calling thread was the last one to arrive. Exactly one thread gets true per phase.
+		///
+		template <class Fn>
+		bool arriveAndWait(Fn&& completion)
+		{
+			// The sense cannot change before this thread has arrived, so it can be read first.
+			bool sense = m_sense.load(std::memory_order_relaxed);
+
+			if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				m_remaining.store(m_threadCount, std::memory_order_relaxed);
+				completion();
+				release(!sense);
+
+				return true;
+			}
+
+			// Phases are often short, so poll until the backoff would sleep before parking.
+			Backoff backoff;
+
+			while (!backoff.isSleeping())
+			{
+				if (m_sense.load(std::memory_order_acquire) != sense)
+					return false;
+
+				backoff.pause();
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_waitingCount.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			m_condition.wait(lock, [this, sense] { return m_sense.load(std::memory_order_acquire) != sense; });
+			m_waitingCount.fetch_sub(1, std::memory_order_relaxed);
+
+			return false;
+		}
+
+
+		/// @return The number of threads the barrier waits for.
+		///
+		std::size_t getThreadCount() const { return m_threadCount; }
+
+
+	private:
+
+		void release(bool sense)
+		{
+			m_sense.store(sense, std::memory_order_release);
+
+			// Pairs with the fence of the parking threads: either they see the new sense or they are seen waiting.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (m_waitingCount.load(std::memory_order_relaxed) == 0)
+				return;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+			}
+
+			m_condition.notify_all();
+		}
+
+
+		const std::size_t m_threadCount;
+		alignas(cacheLineSize) std::atomic<std::size_t> m_remaining;
+		alignas(cacheLineSize) std::atomic<bool> m_sense = false;
+		std::atomic<std::size_t> m_waitingCount = 0;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+	};
+
+}
@@ -0,0 +1,494 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/FutexMutex.hpp"
+#include "SEL/Threads/EpochDomain.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+namespace sel {
+
+	/// @brief Hash map that many threads can read and write at once, for lookup tables shared between threads.
+	///
+	/// The map is split into shards, each an open addressing table of pointers to immutable entries,
+	/// guarded by its own lock. Readers take no lock and never write to shared memory: they pin an EpochDomain,
+	/// follow the pointers and copy the value. Writers lock the shard of the key only, replace the pointer
+	/// and retire the entry they replaced, which is deleted once no reader can hold it.
+	///
+	/// A full shard grows without blocking readers nor the other shards: a larger table is linked after
+	/// the current one and every write to the shard moves a few entries to it, while readers look in both.
+	///
+	/// Every write allocates an entry, so the map suits tables read far more often than they are written.
+	///
+	/// @tparam Key is the type of the keys. It must be equality comparable.
+	/// @tparam Value is the type of the values. It must be copyable.
+	/// @tparam Hash is the type of the hash function.
+	///
+	template <class Key, class Value, class Hash = std::hash<Key>>
+	class ConcurrentHashMap : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param shardCount is the number of shards, thus of writers that can work at once. It is rounded up to a power of two.
+		/// If 0, four shards per hardware thread are used.
+		/// @param domain is the domain in which replaced entries are retired.
+		///
+		explicit ConcurrentHashMap(std::size_t shardCount = 0, EpochDomain& domain = EpochDomain::getDefault())
+			: m_domain(domain)
+		{
+			if (shardCount == 0)
+				shardCount = 4 * std::max(1u, std::thread::hardware_concurrency());
+
+			m_shardCount = 1;
+
+			while (m_shardCount < shardCount)
+			{
+				m_shardCount <<= 1;
+				m_shardBits++;
+			}
+
+			m_shards = createScope<Shard[]>(m_shardCount);
+
+			for (std::size_t i = 0; i < m_shardCount; i++)
+				m_shards[i].table.store(new Table(s_minCapacity), std::memory_order_relaxed);
+		}
+
+		/// @brief Destructor. The map must no longer be used by other threads.
+		///
+		~ConcurrentHashMap()
+		{
+			for (std::size_t i = 0; i < m_shardCount; i++)
+			{
+				for (Table* table = m_shards[i].table.load(std::memory_order_acquire); table != nullptr; )
+				{
+					Table* next = table->next.load(std::memory_order_relaxed);
+
+					for (std::size_t j = 0; j <= table->mask; j++)
+					{
+						Node* node = table->slots[j].load(std::memory_order_relaxed);
+
+						if (isNode(node))
+							delete node;
+					}
+
+					delete table;
+					table = next;
+				}
+			}
+		}
+
+
+		/// @brief Copies the value associated with a key without locking.
+		///
+		/// @param key is the key being looked up.
+		/// @param value is where the value is copied if the key is found.
+		///
+		/// @return The value indicating if the key was found.
+		///
+		bool find(const Key& key, Value& value) const
+		{
+			return read(key, [&](const Value& found) { value = found; });
+		}
+
+		/// @param key is the key being looked up.
+		///
+		/// @return The value indicating if the map contains the key.
+		///
+		bool contains(const Key& key) const
+		{
+			return read(key, [](const Value&) {});
+		}
+
+		/// @brief Calls a function with the value associated with a key, without locking nor copying the value.
+		///
+		/// The value may be replaced by a writer meanwhile, but stays valid until the function returns.
+		///
+		/// @tparam Fn is a callable type taking a const Value&.
+		/// @param key is the key being looked up.
+		/// @param function is the function reading the value. It must not write to this map.
+		///
+		/// @return The value indicating if the key was found.
+		///
+		template <class Fn>
+		bool read(const Key& key, Fn&& function) const
+		{
+			std::size_t hash = getHash(key);
+			const Shard& shard = getShard(hash);
+
+			EpochDomain::Guard guard = m_domain.pin();
+
+			// A table being emptied into the next one still has the entries not moved yet.
+			for (Table* table = shard.table.load(std::memory_order_acquire); table != nullptr; table = table->next.load(std::memory_order_acquire))
+			{
+				if (Node* node = table->find(hash, key, m_shardBits))
+				{
+					function(static_cast<const Value&>(node->value));
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+
+		/// @brief Adds a value if the key is not in the map yet.
+		///
+		/// @param key is the key of the value.
+		/// @param value is the value being added.
+		///
+		/// @return The value indicating if the value was added.
+		///
+		bool insert(const Key& key, const Value& value)
+		{
+			return write(key, [&](Node* current) { return current == nullptr ? new Node{ 0, key, value } : nullptr; });
+		}
+
+		/// @brief Adds a value, or replaces the one associated with the key.
+		///
+		/// @param key is the key of the value.
+		/// @param value is the value being added.
+		///
+		/// @return The value indicating if the value was added rather than replaced.
+		///
+		bool insertOrAssign(const Key& key, const Value& value)
+		{
+			bool isAdded = false;
+
+			write(key, [&](Node* current) {
+				isAdded = current == nullptr;
+				return new Node{ 0, key, value };
+			});
+
+			return isAdded;
+		}
+
+		/// @brief Removes the value associated with a key.
+		///
+		/// @param key is the key of the value.
+		///
+		/// @return The value indicating if the key was found.
+		///
+		bool erase(const Key& key)
+		{
+			return write(key, [](Node* current) { return current == nullptr ? nullptr : getTombstone(); });
+		}
+
+		/// @brief Removes every value.
+		///
+		/// Shards are emptied one after the other, so concurrent readers may see some values removed and not others.
+		///
+		void clear()
+		{
+			for (std::size_t i = 0; i < m_shardCount; i++)
+			{
+				Shard& shard = m_shards[i];
+				std::lock_guard<FutexMutex> lock(shard.mutex);
+
+				Table* table = shard.table.load(std::memory_order_relaxed);
+
+				while (table->next.load(std::memory_order_relaxed) != nullptr)
+					table = migrate(shard, table->mask + 1);
+
+				for (std::size_t j = 0; j <= table->mask; j++)
+				{
+					Node* node = table->slots[j].load(std::memory_order_relaxed);
+
+					if (isNode(node))
+					{
+						table->slots[j].store(getTombstone(), std::memory_order_release);
+						m_domain.retire(node);
+					}
+				}
+
+				shard.size.store(0, std::memory_order_relaxed);
+			}
+		}
+
+
+		/// @brief Counts the values. Writes made during the call may or may not be counted.
+		///
+		/// @return The number of values.
+		///
+		std::size_t getSize() const
+		{
+			std::size_t size = 0;
+
+			for (std::size_t i = 0; i < m_shardCount; i++)
+				size += m_shards[i].size.load(std::memory_order_relaxed);
+
+			return size;
+		}
+
+		/// @return The value indicating if the map has no value.
+		///
+		bool isEmpty() const { return getSize() == 0; }
+
+		/// @return The number of shards.
+		///
+		std::size_t getShardCount() const { return m_shardCount; }
+
+
+	private:
+
+		struct Node
+		{
+			std::size_t hash;
+			const Key key;
+			const Value value;
+		};
+
+		struct Table
+		{
+			explicit Table(std::size_t capacity)
+				: mask(capacity - 1), slots(createScope<std::atomic<Node*>[]>(capacity)) {}
+
+			/// @brief Looks for a key, stopping at the first empty slot. Entries are never moved within a table,
+			/// and a slot never becomes empty again, so a present key is always found.
+			///
+			Node* find(std::size_t hash, const Key& key, std::size_t shardBits) const
+			{
+				for (std::size_t i = hash >> shardBits, probes = 0; probes <= mask; i++, probes++)
+				{
+					Node* node = slots[i & mask].load(std::memory_order_acquire);
+
+					if (node == nullptr)
+						return nullptr;
+
+					if (isNode(node) && node->hash == hash && node->key == key)
+						return node;
+				}
+
+				return nullptr;
+			}
+
+			std::size_t mask;
+			Scope<std::atomic<Node*>[]> slots;
+			/// Table in which the entries are being moved, or nullptr.
+			std::atomic<Table*> next = nullptr;
+
+			// Only accessed by the writers.
+			std::size_t usedCount = 0;
+			std::size_t migrated = 0;
+		};
+
+		struct alignas(cacheLineSize) Shard
+		{
+			/// Oldest table still holding entries. Later ones are linked by Table::next.
+			std::atomic<Table*> table = nullptr;
+			std::atomic<std::size_t> size = 0;
+			FutexMutex mutex;
+		};
+
+
+		/// Marks a removed entry. Probing goes on past it, unlike an empty slot.
+		static Node* getTombstone() { return reinterpret_cast<Node*>(alignof(Node)); }
+
+		static bool isNode(Node* node) { return node != nullptr && node != getTombstone(); }
+
+		std::size_t getHash(const Key& key) const
+		{
+			// Mixes the bits, since std::hash is the identity for integers and the keys often differ in a few bits only.
+			std::uint64_t hash = static_cast<std::uint64_t>(m_hash(key));
+
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdULL;
+			hash ^= hash >> 33;
+			hash *= 0xc4ceb9fe1a85ec53ULL;
+			hash ^= hash >> 33;
+
+			return static_cast<std::size_t>(hash);
+		}
+
+		Shard& getShard(std::size_t hash) const { return m_shards[hash & (m_shardCount - 1)]; }
+
+		/// @brief Looks for the slot of a key in a table locked by the caller.
+		///
+		/// @return The slot holding the key, or else the first free slot on its path.
+		///
+		std::atomic<Node*>& findSlot(Table& table, std::size_t hash, const Key& key, bool& isFound) const
+		{
+			std::atomic<Node*>* freeSlot = nullptr;
+
+			for (std::size_t i = hash >> m_shardBits; ; i++)
+			{
+				std::atomic<Node*>& slot = table.slots[i & table.mask];
+				Node* node = slot.load(std::memory_order_relaxed);
+
+				if (node == nullptr)
+				{
+					isFound = false;
+					return freeSlot != nullptr ? *freeSlot : slot;
+				}
+
+				if (node == getTombstone())
+				{
+					if (freeSlot == nullptr)
+						freeSlot = &slot;
+				}
+				else if (node->hash == hash && node->key == key)
+				{
+					isFound = true;
+					return slot;
+				}
+			}
+		}
+
+		/// @brief Replaces the entry of a key, given the current one or nullptr.
+		///
+		/// @param makeNode returns the new entry, getTombstone() to remove the key, or nullptr to leave it.
+		///
+		template <class MakeNode>
+		bool write(const Key& key, MakeNode&& makeNode)
+		{
+			std::size_t hash = getHash(key);
+			Shard& shard = getShard(hash);
+
+			std::lock_guard<FutexMutex> lock(shard.mutex);
+
+			Table* newest = prepareWrite(shard);
+			Table* oldest = shard.table.load(std::memory_order_relaxed);
+
+			// During a resize, the key is either in the new table or still in the old one.
+			bool isFound = false;
+			std::atomic<Node*>* oldSlot = nullptr;
+
+			if (oldest != newest)
+			{
+				std::atomic<Node*>& slot = findSlot(*oldest, hash, key, isFound);
+
+				if (isFound)
+					oldSlot = &slot;
+			}
+
+			std::atomic<Node*>& slot = findSlot(*newest, hash, key, isFound);
+			Node* current = oldSlot != nullptr ? oldSlot->load(std::memory_order_relaxed) : isFound ? slot.load(std::memory_order_relaxed) : nullptr;
+			Node* node = makeNode(current);
+
+			if (node == nullptr)
+				return false;
+
+			if (node == getTombstone())
+			{
+				(oldSlot != nullptr ? *oldSlot : slot).store(getTombstone(), std::memory_order_release);
+				shard.size.fetch_sub(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				node->hash = hash;
+
+				if (slot.load(std::memory_order_relaxed) == nullptr)
+					newest->usedCount++;
+
+				// Published before the old entry is removed, so that readers always find one of them.
+				slot.store(node, std::memory_order_release);
+
+				if (oldSlot != nullptr)
+					oldSlot->store(getTombstone(), std::memory_order_release);
+
+				if (current == nullptr)
+					shard.size.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (current != nullptr)
+				m_domain.retire(current);
+
+			return true;
+		}
+
+		/// @brief Moves a few entries if the shard is being resized, and starts a resize if the newest table is full.
+		///
+		/// @return The table receiving the writes, which has room for one more entry.
+		///
+		Table* prepareWrite(Shard& shard)
+		{
+			Table* newest = shard.table.load(std::memory_order_relaxed);
+
+			if (newest->next.load(std::memory_order_relaxed) != nullptr)
+				newest = migrate(shard, s_migrationStep);
+
+			if (Table* next = newest->next.load(std::memory_order_relaxed))
+				newest = next;
+
+			if (newest->usedCount + 1 <= (newest->mask + 1) / 4 * 3)
+				return newest;
+
+			// A resize still in progress is finished first, so that there are never more than two tables.
+			while (shard.table.load(std::memory_order_relaxed) != newest)
+				migrate(shard, newest->mask + 1);
+
+			// Sized for the live entries rather than for the slots in use, so that tombstones are dropped.
+			std::size_t capacity = s_minCapacity;
+
+			while (capacity < 4 * (shard.size.load(std::memory_order_relaxed) + 1))
+				capacity <<= 1;
+
+			Table* next = new Table(capacity);
+			newest->next.store(next, std::memory_order_release);
+
+			return next;
+		}
+
+		/// @brief Moves entries from the oldest table to the next one, and drops the oldest table once empty.
+		///
+		/// @return The oldest table after the move.
+		///
+		Table* migrate(Shard& shard, std::size_t slotCount)
+		{
+			Table* oldest = shard.table.load(std::memory_order_relaxed);
+			Table* next = oldest->next.load(std::memory_order_relaxed);
+
+			for (std::size_t end = std::min(oldest->migrated + slotCount, oldest->mask + 1); oldest->migrated < end; oldest->migrated++)
+			{
+				std::atomic<Node*>& slot = oldest->slots[oldest->migrated];
+				Node* node = slot.load(std::memory_order_relaxed);
+
+				if (!isNode(node))
+					continue;
+
+				bool isFound = false;
+				std::atomic<Node*>& target = findSlot(*next, node->hash, node->key, isFound);
+
+				if (target.load(std::memory_order_relaxed) == nullptr)
+					next->usedCount++;
+
+				// Copied before being removed, as for a write.
+				target.store(node, std::memory_order_release);
+				slot.store(getTombstone(), std::memory_order_release);
+			}
+
+			if (oldest->migrated <= oldest->mask)
+				return oldest;
+
+			shard.table.store(next, std::memory_order_release);
+			m_domain.retire(oldest);
+
+			return next;
+		}
+
+
+		static constexpr std::size_t s_minCapacity = 16;
+		/// Number of slots moved by each write during a resize.
+		static constexpr std::size_t s_migrationStep = 16;
+
+		EpochDomain& m_domain;
+		Hash m_hash;
+		std::size_t m_shardCount;
+		std::size_t m_shardBits = 0;
+		Scope<Shard[]> m_shards;
+	};
+
+}
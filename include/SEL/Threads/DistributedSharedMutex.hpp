@@ -0,0 +1,172 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+#include "SEL/Utilities/CachePadded.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Backoff.hpp"
+#include "SEL/Threads/FutexMutex.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+
+namespace sel {
+
+	/// @brief Reader-writer mutex whose readers do not contend with each other.
+	///
+	/// With std::shared_mutex, every reader writes to the same counter, whose cache line then bounces
+	/// between all the cores. Here, each thread is assigned one of several reader counters, each on
+	/// its own cache line, so readers on different cores write to different lines.
+	/// A writer sets a flag, then waits for every counter to drop to zero, so writing costs O(slot count).
+	/// Writers are preferred: new readers wait while a writer is waiting or active.
+	///
+	/// It can be used with BasicReadLock and BasicWriteLock. A shared lock must be released by the thread that took it.
+	/// Each instance uses one cache line per slot, so it is meant for a few heavily read structures.
+	///
+	class DistributedSharedMutex : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param slotCount is the number of reader counters. It is rounded up to a power of two.
+		/// If 0, one counter per hardware thread is used.
+		///
+		explicit DistributedSharedMutex(std::size_t slotCount = 0)
+		{
+			if (slotCount == 0)
+				slotCount = std::max(1u, std::thread::hardware_concurrency());
+
+			m_slotCount = 1;
+
+			while (m_slotCount < slotCount)
+				m_slotCount <<= 1;
+
+			m_slots = createScope<Slot[]>(m_slotCount);
+		}
+
+
+		/// @brief Locks the mutex exclusively, waiting for the other writers and for the readers.
+		///
+		void lock()
+		{
+			m_writerMutex.lock();
+			m_isWriting.store(true, std::memory_order_seq_cst);
+
+			// Pairs with lock_shared(): either the reader sees the flag or its counter is seen here.
+			for (std::size_t i = 0; i < m_slotCount; i++)
+			{
+				Backoff backoff;
+
+				while (m_slots[i]->load(std::memory_order_seq_cst) != 0)
+					backoff.pause();
+			}
+		}
+
+		/// @brief Locks the mutex exclusively if no other thread holds it.
+		///
+		/// @return The value indicating if the mutex was locked.
+		///
+		bool try_lock()
+		{
+			if (!m_writerMutex.try_lock())
+				return false;
+
+			m_isWriting.store(true, std::memory_order_seq_cst);
+
+			for (std::size_t i = 0; i < m_slotCount; i++)
+			{
+				if (m_slots[i]->load(std::memory_order_seq_cst) != 0)
+				{
+					unlock();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// @brief Unlocks the mutex locked exclusively.
+		///
+		void unlock()
+		{
+			m_isWriting.store(false, std::memory_order_release);
+			m_writerMutex.unlock();
+		}
+
+
+		/// @brief Locks the mutex for reading, waiting for the writers.
+		///
+		void lock_shared()
+		{
+			std::atomic<std::uint32_t>& readerCount = getSlot();
+
+			while (true)
+			{
+				readerCount.fetch_add(1, std::memory_order_seq_cst);
+
+				if (!m_isWriting.load(std::memory_order_seq_cst))
+					return;
+
+				// Lets the writer through instead of blocking it.
+				readerCount.fetch_sub(1, std::memory_order_release);
+
+				Backoff backoff;
+
+				while (m_isWriting.load(std::memory_order_relaxed))
+					backoff.pause();
+			}
+		}
+
+		/// @brief Locks the mutex for reading if no writer holds it or waits for it.
+		///
+		/// @return The value indicating if the mutex was locked.
+		///
+		bool try_lock_shared()
+		{
+			std::atomic<std::uint32_t>& readerCount = getSlot();
+
+			readerCount.fetch_add(1, std::memory_order_seq_cst);
+
+			if (!m_isWriting.load(std::memory_order_seq_cst))
+				return true;
+
+			readerCount.fetch_sub(1, std::memory_order_release);
+			return false;
+		}
+
+		/// @brief Unlocks the mutex locked for reading.
+		///
+		void unlock_shared()
+		{
+			getSlot().fetch_sub(1, std::memory_order_release);
+		}
+
+
+		/// @return The number of reader counters.
+		///
+		std::size_t getSlotCount() const { return m_slotCount; }
+
+
+	private:
+
+		using Slot = CachePadded<std::atomic<std::uint32_t>>;
+
+		std::atomic<std::uint32_t>& getSlot()
+		{
+			return *m_slots[utils::getThreadIndex() & (m_slotCount - 1)];
+		}
+
+		std::size_t m_slotCount;
+		Scope<Slot[]> m_slots;
+		alignas(cacheLineSize) std::atomic<bool> m_isWriting = false;
+		FutexMutex m_writerMutex;
+	};
+
+}
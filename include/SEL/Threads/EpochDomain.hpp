@@ -0,0 +1,373 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+#include "SEL/Utilities/CachePadded.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Epoch-based memory reclamation for lock-free structures.
+	///
+	/// A lock-free structure cannot delete a node it unlinked right away, since readers may still be using it.
+	/// Instead, readers pin the domain for as long as they hold pointers into the structure, and writers retire
+	/// the nodes they unlink. The domain has a global epoch, which only advances once every pinned thread has
+	/// seen its current value. A node retired during an epoch is deleted two epochs later, when no reader can
+	/// hold it anymore.
+	///
+	/// Pinning stores the epoch in a slot owned by the thread and issues one fence, without any atomic
+	/// read-modify-write, so readers never write to a shared cache line as they would with Ref.
+	/// Retired nodes are kept in per-thread lists and deleted in batches by the retiring threads.
+	///
+	/// A thread must not keep a domain pinned for long, as no retired node can be deleted meanwhile.
+	/// A domain must not be destroyed while it is pinned. Its destructor deletes every node still retired.
+	///
+	class EpochDomain : public NonCopyable, public NonMovable
+	{
+		struct Record;
+
+	public:
+
+		/// @brief Keeps the domain pinned for the calling thread as long as it exists.
+		///
+		/// Guards may be nested. A guard must be destroyed by the thread that created it.
+		///
+		class Guard : public NonCopyable, public NonMovable
+		{
+		public:
+
+			/// @brief Destructor. Unpins the domain if this is the outermost guard of the thread.
+			///
+			~Guard()
+			{
+				if (--m_record->pinCount == 0)
+					m_record->epoch.store(s_unpinned, std::memory_order_release);
+			}
+
+
+		private:
+
+			explicit Guard(Record* record)
+				: m_record(record) {}
+
+			Record* m_record;
+
+			friend class EpochDomain;
+		};
+
+
+		/// @brief Default constructor.
+		///
+		EpochDomain()
+			: m_state(createRef<State>()), m_id(s_nextId.fetch_add(1, std::memory_order_relaxed)) {}
+
+		/// @brief Destructor. Deletes every retired object.
+		///
+		~EpochDomain()
+		{
+			m_state->deleteRetired();
+
+			// Lets the threads that used the domain drop their share of its state.
+			m_state->isDestroyed.store(true, std::memory_order_release);
+		}
+
+
+		/// @brief Pins the domain for the calling thread.
+		///
+		/// While the returned guard exists, objects read from a structure protected by this domain are not deleted.
+		///
+		/// @return The guard unpinning the domain when destroyed.
+		///
+		Guard pin()
+		{
+			Record* record = getRecord();
+
+			if (record->pinCount++ == 0)
+			{
+				record->epoch.store(toPinned(m_state->epoch.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+
+				// Pairs with tryAdvance(): either the pinned epoch is seen there, or the reads made under the guard see every unlink made before the epoch advanced.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+
+			return Guard(record);
+		}
+
+		/// @brief Retires an object that has been unlinked from the protected structure.
+		///
+		/// It is deleted once no thread can be reading it anymore.
+		///
+		/// @param pointer is the address of the object.
+		/// @param deleter is the function deleting it.
+		///
+		void retire(void* pointer, void (*deleter)(void*))
+		{
+			Record* record = getRecord();
+
+			// The object must be unlinked before the epoch it is tagged with is read.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			record->retired.push_back({ pointer, deleter, m_state->epoch.load(std::memory_order_relaxed) });
+
+			if (record->retired.size() >= s_collectThreshold)
+				collect();
+		}
+
+		/// @brief Retires an object allocated with new.
+		///
+		/// @tparam T is the type of the object.
+		/// @param pointer is the address of the object.
+		///
+		template <class T>
+		void retire(T* pointer)
+		{
+			retire(pointer, [](void* object) { delete static_cast<T*>(object); });
+		}
+
+		/// @brief Tries to advance the epoch, then deletes the objects retired by the calling thread that are no longer read.
+		///
+		/// It is called automatically every few retirements.
+		///
+		void collect()
+		{
+			std::uint64_t epoch = m_state->tryAdvance();
+
+			deleteExpired(getRecord()->retired, epoch);
+
+			// Objects left by exited threads are deleted by whichever thread gets there first.
+			std::unique_lock<std::mutex> lock(m_state->orphanMutex, std::try_to_lock);
+
+			if (lock.owns_lock())
+				deleteExpired(m_state->orphans, epoch);
+		}
+
+
+		/// @return The current global epoch.
+		///
+		std::uint64_t getEpoch() const { return m_state->epoch.load(std::memory_order_relaxed); }
+
+		/// @return The domain shared by the structures that are not given their own.
+		///
+		static EpochDomain& getDefault()
+		{
+			// Never destroyed, so that threads still running during the static destruction can use it.
+			static EpochDomain* domain = new EpochDomain();
+
+			return *domain;
+		}
+
+
+	private:
+
+		struct Retired
+		{
+			void* pointer;
+			void (*deleter)(void*);
+			std::uint64_t epoch;
+		};
+
+		struct alignas(cacheLineSize) Record
+		{
+			/// Epoch seen when pinning, or s_unpinned.
+			std::atomic<std::uint64_t> epoch = s_unpinned;
+			std::atomic<bool> isUsed = true;
+			Record* next = nullptr;
+
+			// Only accessed by the thread using the record.
+			unsigned int pinCount = 0;
+			std::vector<Retired> retired;
+		};
+
+		/// Outlives the domain until every thread that used it has exited, since threads release their record on exit.
+		struct State
+		{
+			alignas(cacheLineSize) std::atomic<std::uint64_t> epoch = 0;
+			std::atomic<Record*> records = nullptr;
+			std::mutex orphanMutex;
+			std::vector<Retired> orphans;
+			std::atomic<bool> isDestroyed = false;
+
+			~State()
+			{
+				deleteRetired();
+
+				for (Record* record = records.load(std::memory_order_acquire); record != nullptr; )
+				{
+					Record* next = record->next;
+					delete record;
+					record = next;
+				}
+			}
+
+			std::uint64_t tryAdvance()
+			{
+				// Acquiring makes the unpinning of every reader happen before the deletions allowed by the new epoch.
+				std::uint64_t current = epoch.load(std::memory_order_acquire);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+				{
+					std::uint64_t pinned = record->epoch.load(std::memory_order_acquire);
+
+					if (pinned != s_unpinned && pinned != toPinned(current))
+						return current;
+				}
+
+				// Fails if another thread advanced first, which is just as good.
+				if (epoch.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+					current++;
+
+				return current;
+			}
+
+			void deleteRetired()
+			{
+				for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+					deleteAll(record->retired);
+
+				std::lock_guard<std::mutex> lock(orphanMutex);
+				deleteAll(orphans);
+			}
+		};
+
+		struct ThreadEntry
+		{
+			std::uint64_t domainId;
+			Ref<State> state;
+			Record* record;
+		};
+
+		/// Records of the thread in every domain it used, released when it exits.
+		struct ThreadRecords
+		{
+			std::vector<ThreadEntry> entries;
+
+			~ThreadRecords()
+			{
+				for (ThreadEntry& entry : entries)
+				{
+					Record* record = entry.record;
+
+					if (!record->retired.empty())
+					{
+						std::lock_guard<std::mutex> lock(entry.state->orphanMutex);
+
+						entry.state->orphans.insert(entry.state->orphans.end(), record->retired.begin(), record->retired.end());
+						record->retired.clear();
+					}
+
+					record->epoch.store(s_unpinned, std::memory_order_relaxed);
+					record->isUsed.store(false, std::memory_order_release);
+				}
+
+				s_cache = { 0, nullptr };
+			}
+		};
+
+		/// Last record looked up by the thread, which is usually the one looked up next.
+		struct ThreadCache
+		{
+			std::uint64_t domainId;
+			Record* record;
+		};
+
+
+		static constexpr std::uint64_t toPinned(std::uint64_t epoch) { return (epoch << 1) | 1; }
+
+		static void deleteAll(std::vector<Retired>& retired)
+		{
+			std::vector<Retired> deleted;
+			deleted.swap(retired);
+
+			for (const Retired& object : deleted)
+				object.deleter(object.pointer);
+		}
+
+		static void deleteExpired(std::vector<Retired>& retired, std::uint64_t epoch)
+		{
+			auto expired = std::partition(retired.begin(), retired.end(), [=](const Retired& object) { return object.epoch + 2 > epoch; });
+
+			// Moved out first, since a deleter may retire other objects.
+			std::vector<Retired> deleted(expired, retired.end());
+			retired.erase(expired, retired.end());
+
+			for (const Retired& object : deleted)
+				object.deleter(object.pointer);
+		}
+
+		Record* getRecord()
+		{
+			if (s_cache.domainId == m_id)
+				return s_cache.record;
+
+			static thread_local ThreadRecords threadRecords;
+
+			// Entries of destroyed domains are dropped, so that a long-lived thread does not keep every domain it ever used alive.
+			auto& entries = threadRecords.entries;
+
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [](const ThreadEntry& entry) {
+				return entry.state->isDestroyed.load(std::memory_order_acquire);
+			}), entries.end());
+
+			Record* record = nullptr;
+
+			for (const ThreadEntry& entry : threadRecords.entries)
+			{
+				if (entry.domainId == m_id)
+					record = entry.record;
+			}
+
+			if (record == nullptr)
+			{
+				record = acquireRecord();
+				threadRecords.entries.push_back({ m_id, m_state, record });
+			}
+
+			s_cache = { m_id, record };
+
+			return record;
+		}
+
+		Record* acquireRecord()
+		{
+			// Reuses the record of an exited thread if there is one.
+			for (Record* record = m_state->records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+			{
+				bool isUsed = false;
+
+				if (!record->isUsed.load(std::memory_order_relaxed) && record->isUsed.compare_exchange_strong(isUsed, true, std::memory_order_acquire))
+					return record;
+			}
+
+			Record* record = new Record();
+			record->next = m_state->records.load(std::memory_order_relaxed);
+
+			while (!m_state->records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed));
+
+			return record;
+		}
+
+
+		static constexpr std::uint64_t s_unpinned = 0;
+		/// Number of objects a thread retires before trying to delete them.
+		static constexpr std::size_t s_collectThreshold = 64;
+
+		static inline std::atomic<std::uint64_t> s_nextId = 1;
+		static inline thread_local ThreadCache s_cache = { 0, nullptr };
+
+		Ref<State> m_state;
+		std::uint64_t m_id;
+	};
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/Backoff.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+
+namespace sel {
+
+	/// @brief Compact mutex that only makes a system call when threads actually contend for it.
+	///
+	/// The whole mutex is a 32-bit word: 0 when unlocked, 1 when locked and 2 when locked with waiting threads.
+	/// Uncontended locking and unlocking are a single atomic instruction each. A contended thread spins for
+	/// a short while, then sleeps on a Linux futex. Elsewhere, it yields instead of sleeping.
+	///
+	/// The shared locking methods lock exclusively, so the mutex can be used with ReadLock-style locks
+	/// as well. Readers are then serialized, which is usually cheaper than std::shared_mutex for short critical sections.
+	///
+	class FutexMutex : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Default constructor. The mutex is unlocked.
+		///
+		FutexMutex() = default;
+
+
+		/// @brief Locks the mutex, waiting for it if needed.
+		///
+		void lock()
+		{
+			std::uint32_t state = s_unlocked;
+
+			if (!m_state.compare_exchange_strong(state, s_locked, std::memory_order_acquire, std::memory_order_relaxed))
+				lockContended(state);
+		}
+
+		/// @brief Locks the mutex if it is unlocked.
+		///
+		/// @return The value indicating if the mutex was locked.
+		///
+		bool try_lock()
+		{
+			std::uint32_t state = s_unlocked;
+
+			return m_state.compare_exchange_strong(state, s_locked, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		/// @brief Unlocks the mutex and wakes a waiting thread if there is one.
+		///
+		void unlock()
+		{
+			if (m_state.exchange(s_unlocked, std::memory_order_release) == s_contended)
+				wake();
+		}
+
+		/// @brief Same as lock().
+		///
+		void lock_shared() { lock(); }
+
+		/// @brief Same as try_lock().
+		///
+		/// @return The value indicating if the mutex was locked.
+		///
+		bool try_lock_shared() { return try_lock(); }
+
+		/// @brief Same as unlock().
+		///
+		void unlock_shared() { unlock(); }
+
+
+	private:
+
+		void lockContended(std::uint32_t state)
+		{
+			// The owner often releases the mutex quickly, so spin a little before sleeping.
+			for (unsigned int i = 0; i < s_spinCount && state != s_contended; i++)
+			{
+				utils::cpuRelax();
+				state = s_unlocked;
+
+				if (m_state.compare_exchange_weak(state, s_locked, std::memory_order_acquire, std::memory_order_relaxed))
+					return;
+			}
+
+			// From now on the mutex is marked contended, so that the owner wakes a thread when unlocking.
+			while (m_state.exchange(s_contended, std::memory_order_acquire) != s_unlocked)
+				wait();
+		}
+
+		void wait()
+		{
+#ifdef __linux__
+			// Returns right away if the state changed in the meantime, so no wake-up can be lost.
+			syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_state), FUTEX_WAIT_PRIVATE, s_contended, nullptr, nullptr, 0);
+#else
+			std::this_thread::yield();
+#endif
+		}
+
+		void wake()
+		{
+#ifdef __linux__
+			syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+		}
+
+
+		static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && std::atomic<std::uint32_t>::is_always_lock_free,
+			"The futex word must be a plain 32-bit integer.");
+
+		static constexpr std::uint32_t s_unlocked = 0;
+		static constexpr std::uint32_t s_locked = 1;
+		static constexpr std::uint32_t s_contended = 2;
+		/// Number of attempts a contended thread makes before sleeping.
+		static constexpr unsigned int s_spinCount = 100;
+
+		std::atomic<std::uint32_t> m_state = s_unlocked;
+	};
+
+}
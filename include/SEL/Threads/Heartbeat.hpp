@@ -0,0 +1,60 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace sel {
+
+	class Watchdog;
+
+
+	/// @brief Progress signal written by a monitored thread and read by a Watchdog.
+	///
+	/// The thread calls beat() when it starts a unit of work and setIdle() before it waits for work,
+	/// so that waiting is not mistaken for a stall. Both methods are a single relaxed store:
+	/// the watchdog timestamps the changes itself, so the monitored thread never reads the clock.
+	/// Only one thread may write a given heartbeat.
+	///
+	class alignas(cacheLineSize) Heartbeat : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Default constructor. The heartbeat starts idle.
+		///
+		Heartbeat() = default;
+
+
+		/// @brief Signals that the thread is making progress.
+		///
+		void beat()
+		{
+			// Beats count in steps of 2, the lowest bit tells if the thread is idle.
+			std::uint64_t value = m_value.load(std::memory_order_relaxed);
+			m_value.store((value | s_idleBit) + 1, std::memory_order_relaxed);
+		}
+
+		/// @brief Signals that the thread is waiting for work and must not be considered stalled until the next beat.
+		///
+		void setIdle()
+		{
+			std::uint64_t value = m_value.load(std::memory_order_relaxed);
+			m_value.store(value | s_idleBit, std::memory_order_relaxed);
+		}
+
+
+	private:
+
+		friend class Watchdog;
+
+		static constexpr std::uint64_t s_idleBit = 1;
+
+		std::atomic<std::uint64_t> m_value = s_idleBit;
+	};
+
+}
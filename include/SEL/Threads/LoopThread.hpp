@@ -4,16 +4,43 @@
 
 #include "SEL/Threads/ThreadCore.hpp"
 #include "SEL/Threads/Thread.hpp"
-
+#include "SEL/Threads/Heartbeat.hpp"
+#include "SEL/Threads/Backoff.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <utility>
+#include <vector>
 
 
 namespace sel {
 
 	/// @brief Represents and controls a thread of execution that will repeat a task.
 	/// 
-	class LoopThread : public NonCopyable
+	/// The task is stored in a std::function by default. Using sel::InplaceFunction instead
+	/// avoids the heap allocation std::function may make and keeps the task inside the object.
+	/// 
+	/// Defining SEL_LOOP_THREAD_METRICS before including this header makes the thread measure
+	/// every repetition of the task, see getIterationStats(). Without it, nothing is measured.
+	/// The statistics are members in every build, so the layout of the class does not depend on the macro.
+	/// 
+	/// @tparam Task is the type storing the task. It must be callable without arguments, movable,
+	/// swappable and constructible from the callables given to the thread.
+	/// @tparam Lockable is the type of the internal mutex. FutexMutex is lighter than the default std::shared_mutex.
+	/// 
+	template <class Task = std::function<void()>, class Lockable = Mutex>
+	class BasicLoopThread : public NonCopyable
 	{
+	private:
+
+		using ReadLock = BasicReadLock<Lockable>;
+		using WriteLock = BasicWriteLock<Lockable>;
+
 	public:
 
 		/// @brief Specifies the possible states of the thread.
@@ -27,10 +54,51 @@ namespace sel {
 			Joined	= 0b1000,		///< The thread has finished its execution and joined another thread.
 		};
 
+		/// @brief Specifies how the thread schedules the repetitions of the task.
+		///
+		enum class Mode
+		{
+			Continuous,		///< The task is repeated back to back. This is the default mode.
+			EventDriven,	///< The task is repeated only after a call to notify() or while the work predicate is true. Otherwise the thread sleeps.
+			FixedRate,		///< The task is repeated once per period, at absolute deadlines.
+		};
+
+		/// @brief Timing statistics of a thread in fixed-rate mode.
+		///
+		/// Lateness is the delay between a deadline and the moment the task actually started.
+		///
+		struct RateStats
+		{
+			std::uint64_t tickCount;					///< Number of repetitions performed since the thread started.
+			std::uint64_t overrunCount;					///< Number of repetitions that ended after the next deadline.
+			std::uint64_t skippedCount;					///< Number of deadlines dropped because of overruns.
+			std::chrono::nanoseconds minLateness;		///< Smallest lateness observed.
+			std::chrono::nanoseconds meanLateness;		///< Average lateness.
+			std::chrono::nanoseconds maxLateness;		///< Largest lateness observed.
+		};
+
+		/// @brief Number of buckets of the iteration time histogram.
+		///
+		static constexpr std::size_t histogramSize = 40;
+
+		/// @brief Duration statistics of the repetitions of the task.
+		///
+		/// Bucket 0 of the histogram counts the repetitions shorter than 1ns. Bucket i counts the ones
+		/// lasting from 2^(i-1) to 2^i - 1 nanoseconds, and the last bucket also counts all the longer ones.
+		///
+		struct IterationStats
+		{
+			std::uint64_t iterationCount;							///< Number of repetitions performed since the thread started.
+			std::chrono::nanoseconds minTime;						///< Shortest repetition.
+			std::chrono::nanoseconds meanTime;						///< Average duration of a repetition.
+			std::chrono::nanoseconds maxTime;						///< Longest repetition.
+			std::array<std::uint64_t, histogramSize> histogram;		///< Number of repetitions per power of two of nanoseconds.
+		};
+
 
 		/// @brief Default constructor. No task will be assigned to a thread.
 		/// 
-		LoopThread()
+		BasicLoopThread()
 		{
 			init();
 		}
@@ -41,8 +109,9 @@ namespace sel {
 		/// 
 		/// @return The newly constructed LoopThread object.
 		/// 
-		LoopThread(LoopThread&& other) noexcept
+		BasicLoopThread(BasicLoopThread&& other) noexcept
 		{
+			init();
 			move(other);
 		}
 
@@ -50,8 +119,8 @@ namespace sel {
 		/// 
 		/// @param function is the task that will be repeated by the thread.
 		/// 
-		LoopThread(std::function<void()> function)
-			: m_onLoop(function)
+		BasicLoopThread(Task function)
+			: m_onLoop(std::move(function))
 		{
 			init();
 		}
@@ -63,15 +132,15 @@ namespace sel {
 		/// @param object is the object needed to call the method.
 		/// 
 		template <class C>
-		LoopThread(void(C::* method)(), C* object)
-			: m_onLoop(std::bind(method, object))
+		BasicLoopThread(void(C::* method)(), C* object)
+			: m_onLoop([method, object] { (object->*method)(); })
 		{
 			init();
 		}
 
 		/// @brief Destructor that will call stop() and join() before deleting the instance.
 		///
-		~LoopThread()
+		~BasicLoopThread()
 		{
 			join();
 		}
@@ -86,14 +155,14 @@ namespace sel {
 		/// 
 		/// @return The value indicating if the task could be assigned to the thread.
 		/// 
-		bool setOnLoopFunc(std::function<void()> function)
+		bool setOnLoopFunc(Task function)
 		{
 			if (getState() == State::Running)
 				return false;
 
 			WriteLock write(m_mutex);
 
-			m_onLoop = function;
+			m_onLoop = std::move(function);
 			return true;
 		}
 		
@@ -111,7 +180,186 @@ namespace sel {
 		template <class C>
 		bool setOnLoopFunc(void(C::* method)(), C* object)
 		{
-			return setOnLoopFunc(std::bind(method, object));
+			return setOnLoopFunc([method, object] { (object->*method)(); });
+		}
+
+		/// @brief Sets how the thread schedules the repetitions of the task.
+		/// 
+		/// The method returns true if the mode could be set. 
+		/// If false is returned, make sure the thread was not running.
+		/// 
+		/// @param mode is the new scheduling mode.
+		/// 
+		/// @return The value indicating if the mode could be set.
+		/// 
+		bool setMode(Mode mode)
+		{
+			if (getState() == State::Running)
+				return false;
+
+			WriteLock write(m_mutex);
+
+			m_mode = mode;
+			return true;
+		}
+
+		/// @brief Sets the period of the repetitions in fixed-rate mode.
+		/// 
+		/// Deadlines are absolute, so the time spent in the task does not make the rate drift.
+		/// The thread sleeps until shortly before each deadline then spins until it is reached,
+		/// which gives a much better precision than sleeping alone.
+		/// If a repetition ends after the next deadline, it is counted as an overrun and the task starts again right away.
+		/// Deadlines that were entirely missed are skipped rather than caught up.
+		/// 
+		/// The method returns true if the period could be set. 
+		/// If false is returned, make sure the thread was not running.
+		/// 
+		/// @param period is the time between two deadlines.
+		/// @param spinThreshold is how long before a deadline the thread stops sleeping and starts spinning.
+		/// 
+		/// @return The value indicating if the period could be set.
+		/// 
+		bool setPeriod(std::chrono::nanoseconds period, std::chrono::nanoseconds spinThreshold = std::chrono::microseconds(200))
+		{
+			if (getState() == State::Running)
+				return false;
+
+			WriteLock write(m_mutex);
+
+			m_period = period;
+			m_spinThreshold = spinThreshold;
+			return true;
+		}
+
+		/// @brief Sets how the thread waits when it polls: while paused before parking, and before a deadline in fixed-rate mode.
+		/// 
+		/// A paused thread polls until the backoff would sleep, then parks until it is resumed. Using Backoff::neverSleep
+		/// as yield count thus makes it poll until resumed, which gives the fastest resume at the cost of a busy core.
+		/// Before a deadline, sleeps are shortened so as not to oversleep it.
+		/// 
+		/// The method returns true if the backoff could be set. 
+		/// If false is returned, make sure the thread was neither running nor paused, since a paused thread reads the backoff too.
+		/// 
+		/// @param backoff is the waiting policy.
+		/// 
+		/// @return The value indicating if the backoff could be set.
+		/// 
+		bool setBackoff(const Backoff& backoff)
+		{
+			if (isThreadAlive())
+				return false;
+
+			WriteLock write(m_mutex);
+
+			m_backoff = backoff;
+			m_backoff.reset();
+			return true;
+		}
+
+		/// @brief Restricts the thread to the given logical CPUs.
+		/// 
+		/// The affinity is kept and applied again every time a thread is started.
+		/// Only supported on Linux.
+		/// 
+		/// @param cpus are the identifiers of the logical CPUs the thread may run on. An empty list restores the default affinity,
+		/// which is every CPU the calling thread is allowed to run on.
+		/// 
+		/// @return The value indicating if the affinity could be applied to the current thread. True is returned if no thread is running.
+		/// 
+		bool setAffinity(const std::vector<unsigned int>& cpus)
+		{
+			WriteLock write(m_mutex);
+
+			m_affinity = cpus;
+
+			if (!isThreadAlive())
+				return true;
+
+			return m_thread.setAffinity(cpus.empty() ? utils::getAllowedCpus() : cpus);
+		}
+
+		/// @brief Names the thread so that tools like top, perf or debuggers can show it.
+		/// 
+		/// The name is kept and applied again every time a thread is started.
+		/// Only supported on Linux, where the name is truncated to 15 characters.
+		/// 
+		/// @param name is the name of the thread.
+		/// 
+		/// @return The value indicating if the name could be applied to the current thread. True is returned if no thread is running.
+		/// 
+		bool setName(const std::string& name)
+		{
+			WriteLock write(m_mutex);
+
+			m_name = name;
+			return !isThreadAlive() || m_thread.setName(name);
+		}
+
+		/// @brief Sets the scheduling policy and priority of the thread.
+		/// 
+		/// The scheduling is kept and applied again every time a thread is started.
+		/// Only supported on Linux. Real-time policies usually require privileges.
+		/// 
+		/// @param policy is the scheduling policy, such as SCHED_OTHER, SCHED_FIFO or SCHED_RR.
+		/// @param priority is the static priority, which must be 0 for SCHED_OTHER.
+		/// 
+		/// @return The value indicating if the scheduling could be applied to the current thread. True is returned if no thread is running.
+		/// 
+		bool setScheduling(int policy, int priority)
+		{
+			WriteLock write(m_mutex);
+
+			m_hasScheduling = true;
+			m_schedulingPolicy = policy;
+			m_schedulingPriority = priority;
+			return !isThreadAlive() || m_thread.setScheduling(policy, priority);
+		}
+
+		/// @brief Makes the thread beat a heartbeat before each repetition of the task, usually one given by a Watchdog.
+		/// 
+		/// The heartbeat is marked idle while the thread waits, whether it is paused, waiting for work or for a deadline.
+		/// 
+		/// The method returns true if the heartbeat could be assigned. 
+		/// If false is returned, make sure the thread was not running.
+		/// 
+		/// @param heartbeat is the heartbeat, which must outlive its use by the thread. nullptr stops beating.
+		/// 
+		/// @return The value indicating if the heartbeat could be assigned.
+		/// 
+		bool setHeartbeat(Heartbeat* heartbeat)
+		{
+			if (getState() == State::Running)
+				return false;
+
+			WriteLock write(m_mutex);
+
+			m_heartbeat = heartbeat;
+			return true;
+		}
+
+		/// @brief Assigns the predicate telling if work is available in event-driven mode.
+		/// 
+		/// While the predicate returns true, the task is repeated without waiting for notify().
+		/// Once it returns false, the thread sleeps until notify() is called, so producers still have to notify
+		/// after making work available. The predicate is called with the internal mutex locked: it must be cheap
+		/// and must not call methods of this LoopThread.
+		/// 
+		/// The method returns true if the predicate could be assigned. 
+		/// If false is returned, make sure the thread was not running.
+		/// 
+		/// @param predicate is the function telling if work is available. An empty function removes the predicate.
+		/// 
+		/// @return The value indicating if the predicate could be assigned.
+		/// 
+		bool setWorkPredicate(std::function<bool()> predicate)
+		{
+			if (getState() == State::Running)
+				return false;
+
+			WriteLock write(m_mutex);
+
+			m_hasWork = predicate;
+			return true;
 		}
 
 
@@ -119,11 +367,11 @@ namespace sel {
 		/// 
 		void start()
 		{
+			join();
+
 			WriteLock write(m_mutex);
 
-			stopScript();
-			join(false);
-			m_isStopAsked = false;
+			m_requests.store(0, std::memory_order_relaxed);
 			startThread();
 		}
 
@@ -133,18 +381,39 @@ namespace sel {
 		/// 
 		void pause()
 		{
-			ReadLock read(m_mutex);
+			WriteLock write(m_mutex);
 
-			if (m_state == State::Running)
+			if (m_state.load(std::memory_order_relaxed) == State::Running)
 			{
-				read.unlock();
-				WriteLock write(m_mutex);
+				m_requests.fetch_or(s_pauseRequest, std::memory_order_release);
+				m_condition.notify_all();
 
-				m_isPauseAsked = true;
+				// The thread notifies once it has parked or stopped. A resume asked meanwhile cancels the pause instead.
+				m_condition.wait(write, [this] {
+					return m_state.load(std::memory_order_relaxed) != State::Running || !(m_requests.load(std::memory_order_relaxed) & s_pauseRequest);
+				});
+			}
+		}
 
-				write.unlock();
+		/// @brief Signals the thread that work is available when in event-driven mode.
+		/// 
+		/// Notifications are coalesced: however many times the method is called before the thread wakes up,
+		/// a single extra repetition of the task is performed.
+		/// 
+		void notify()
+		{
+			// A notification is already pending.
+			if (m_isNotified.exchange(true, std::memory_order_seq_cst))
+				return;
+
+			// Pairs with waitForWork(): either the thread is seen sleeping or it sees the notification.
+			if (m_isWaitingForWork.load(std::memory_order_seq_cst))
+			{
+				{
+					WriteLock write(m_mutex);
+				}
 
-				WAIT_FOR(getState() != State::Running);
+				m_condition.notify_all();
 			}
 		}
 
@@ -181,7 +450,7 @@ namespace sel {
 			bool success = m_thread.join();
 
 			if (success)
-				m_state = State::Joined;
+				m_state.store(State::Joined, std::memory_order_release);
 
 			return success;
 		}
@@ -190,49 +459,92 @@ namespace sel {
 		/// @return The thread's state.
 		///
 		State getState() const
+		{
+			return m_state.load(std::memory_order_acquire);
+		}
+
+		/// @return The timing statistics of fixed-rate mode since the thread started. It can be called from any thread.
+		///
+		RateStats getRateStats() const
+		{
+			RateStats stats;
+
+			stats.tickCount = m_tickCount.load(std::memory_order_relaxed);
+			stats.overrunCount = m_overrunCount.load(std::memory_order_relaxed);
+			stats.skippedCount = m_skippedCount.load(std::memory_order_relaxed);
+			stats.minLateness = std::chrono::nanoseconds(stats.tickCount ? m_minLateness.load(std::memory_order_relaxed) : 0);
+			stats.maxLateness = std::chrono::nanoseconds(m_maxLateness.load(std::memory_order_relaxed));
+			stats.meanLateness = std::chrono::nanoseconds(stats.tickCount ? m_latenessSum.load(std::memory_order_relaxed) / (std::int64_t)stats.tickCount : 0);
+
+			return stats;
+		}
+
+		/// @brief Reads the duration statistics of the task since the thread started. It can be called from any thread.
+		///
+		/// The statistics are only collected if SEL_LOOP_THREAD_METRICS is defined. Otherwise they are all 0.
+		/// As they are read while being updated, the fields may be off by the repetition being recorded.
+		///
+		/// @return The duration statistics of the task.
+		///
+		IterationStats getIterationStats() const
+		{
+			IterationStats stats{};
+
+			stats.iterationCount = m_iterationCount.load(std::memory_order_relaxed);
+			stats.minTime = std::chrono::nanoseconds(stats.iterationCount ? m_minIterationTime.load(std::memory_order_relaxed) : 0);
+			stats.maxTime = std::chrono::nanoseconds(m_maxIterationTime.load(std::memory_order_relaxed));
+			stats.meanTime = std::chrono::nanoseconds(stats.iterationCount ? m_iterationTimeSum.load(std::memory_order_relaxed) / (std::int64_t)stats.iterationCount : 0);
+
+			for (std::size_t i = 0; i < histogramSize; i++)
+				stats.histogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+
+			return stats;
+		}
+
+		/// @return The thread's scheduling mode.
+		///
+		Mode getMode() const
 		{
 			ReadLock read(m_mutex);
 
-			return m_state;
+			return m_mode;
 		}
 
 
 		/// @brief Swaps two LoopThread objects.
 		/// 
+		/// Both threads are joined before their tasks are swapped and restarted.
+		/// 
 		/// @param is the other LoopThread object being swapped.
 		/// 
-		void swap(LoopThread& other)
+		void swap(BasicLoopThread& other)
 		{
 			if (this != &other)
 			{
-				ReadLock thisRead(m_mutex);
-				ReadLock otherRead(other.m_mutex);
-
-				State thisState = m_state;
-				bool thisPause = m_isPauseAsked;
-				bool thisStop = m_isStopAsked;
-
-				State otherState = other.m_state;
-				bool otherPause = other.m_isPauseAsked;
-				bool otherStop = other.m_isStopAsked;
+				State thisState = getState();
+				unsigned int thisRequests = m_requests.load(std::memory_order_acquire);
 
-				thisRead.unlock();
-				otherRead.unlock();
+				State otherState = other.getState();
+				unsigned int otherRequests = other.m_requests.load(std::memory_order_acquire);
 
-				stop();
-				other.stop();
+				join();
+				other.join();
 
 				m_onLoop.swap(other.m_onLoop);
-				auto temp = m_onLoop;
-				m_onLoop = other.m_onLoop;
-				other.m_onLoop = temp;
-
-				// If the thread was busy while not supposed to stop.
-				if (((int)otherState & ((int)State::Running | (int)State::Paused)) && !otherStop)
-					startThread();
-
-				if (((int)thisState & ((int)State::Running | (int)State::Paused)) && !thisStop)
-					other.startThread();
+				m_hasWork.swap(other.m_hasWork);
+				std::swap(m_mode, other.m_mode);
+				std::swap(m_period, other.m_period);
+				std::swap(m_spinThreshold, other.m_spinThreshold);
+				m_affinity.swap(other.m_affinity);
+				m_name.swap(other.m_name);
+				std::swap(m_hasScheduling, other.m_hasScheduling);
+				std::swap(m_schedulingPolicy, other.m_schedulingPolicy);
+				std::swap(m_schedulingPriority, other.m_schedulingPriority);
+				std::swap(m_heartbeat, other.m_heartbeat);
+				std::swap(m_backoff, other.m_backoff);
+
+				restartThread(otherState, otherRequests);
+				other.restartThread(thisState, thisRequests);
 			}
 		}
 
@@ -242,7 +554,7 @@ namespace sel {
 		/// 
 		/// @return The newly constructed LoopThread object.
 		/// 
-		LoopThread& operator=(LoopThread&& other) noexcept
+		BasicLoopThread& operator=(BasicLoopThread&& other) noexcept
 		{
 			if (this != &other)
 				move(other);
@@ -255,95 +567,381 @@ namespace sel {
 
 		void init()
 		{
-			m_state = State::None;
-			m_isPauseAsked = false;
-			m_isStopAsked = true;
+			m_state.store(State::None, std::memory_order_relaxed);
+			m_requests.store(s_stopRequest, std::memory_order_relaxed);
+			m_isNotified.store(false, std::memory_order_relaxed);
+			m_isWaitingForWork.store(false, std::memory_order_relaxed);
+			m_mode = Mode::Continuous;
+			m_period = std::chrono::nanoseconds(0);
+			m_spinThreshold = std::chrono::microseconds(200);
+			m_hasScheduling = false;
+			m_schedulingPolicy = 0;
+			m_schedulingPriority = 0;
+			m_heartbeat = nullptr;
+			m_backoff = Backoff();
+			resetIterationStats();
+		}
+
+		void move(BasicLoopThread& other)
+		{
+			State state = other.getState();
+			unsigned int requests = other.m_requests.load(std::memory_order_acquire);
+
+			join();
+			other.join();
+
+			m_onLoop = std::move(other.m_onLoop);
+			m_hasWork = std::move(other.m_hasWork);
+			m_mode = other.m_mode;
+			m_period = other.m_period;
+			m_spinThreshold = other.m_spinThreshold;
+			m_affinity = std::move(other.m_affinity);
+			m_name = std::move(other.m_name);
+			m_hasScheduling = other.m_hasScheduling;
+			m_schedulingPolicy = other.m_schedulingPolicy;
+			m_schedulingPriority = other.m_schedulingPriority;
+			m_heartbeat = other.m_heartbeat;
+			m_backoff = other.m_backoff;
+			other.init();
+
+			restartThread(state, requests);
 		}
 
-		void move(LoopThread& other)
+		void threadLoop()
 		{
-			ReadLock read(other.m_mutex);
+			while (true)
+			{
+				// While nothing is asked, a single relaxed load is paid per iteration.
+				if (m_requests.load(std::memory_order_relaxed) != 0 && !handleRequests())
+					break;
 
-			State state = other.m_state;
-			bool pause = other.m_isPauseAsked;
-			bool stop = other.m_isStopAsked;
+				if (m_mode == Mode::EventDriven && !waitForWork())
+					continue;
 
-			read.unlock();
+				if (m_mode == Mode::FixedRate && !waitForDeadline())
+					continue;
 
-			other.stop();
-			other.m_state = State::None;
+				if (m_heartbeat)
+					m_heartbeat->beat();
 
-			m_onLoop = std::move(other.m_onLoop);
+#ifdef SEL_LOOP_THREAD_METRICS
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-			m_isPauseAsked = pause;
-			m_isStopAsked = stop;
+				// Loop script
+				m_onLoop();
 
-			// If the thread was busy while not supposed to stop.
-			if (((int)state & ((int)State::Running | (int)State::Paused)) && !stop)
-				startThread();
+				recordIteration(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+#else
+				// Loop script
+				m_onLoop();
+#endif
+			}
 		}
 
-		void threadLoop()
+		bool handleRequests()
 		{
+			markIdle();
+
+			WriteLock write(m_mutex);
+
 			while (true)
 			{
+				unsigned int requests = m_requests.load(std::memory_order_relaxed);
+
+				if (requests & s_stopRequest)
 				{
-					ReadLock read(m_mutex);
+					m_state.store(State::Stopped, std::memory_order_release);
+					m_condition.notify_all();
+					return false;
+				}
 
-					if (m_isStopAsked)
-					{
-						read.unlock();
+				if (!(requests & s_pauseRequest))
+					return true;
 
-						WriteLock write(m_mutex);
-						m_state = State::Stopped;
-						break;
-					}
+				m_state.store(State::Paused, std::memory_order_release);
+				m_condition.notify_all();
+				write.unlock();
 
-					if (m_isPauseAsked)
-					{
-						read.unlock();
+				waitWhilePaused();
+
+				// Deadlines start again from the resume instead of catching up the paused time.
+				m_isDeadlineSet = false;
+
+				// A stop may have been asked while the thread was paused.
+				write.lock();
+			}
+		}
+
+		bool waitForWork()
+		{
+			// Resets the notification so that all the ones received until now lead to a single repetition.
+			if (m_isNotified.exchange(false, std::memory_order_acquire))
+				return true;
+
+			WriteLock write(m_mutex);
+
+			if (m_hasWork && m_hasWork())
+				return true;
+
+			markIdle();
+			m_isWaitingForWork.store(true, std::memory_order_seq_cst);
+			m_condition.wait(write, [this] {
+				return m_isNotified.load(std::memory_order_seq_cst) || m_requests.load(std::memory_order_relaxed) != 0 || (m_hasWork && m_hasWork());
+			});
+			m_isWaitingForWork.store(false, std::memory_order_relaxed);
+
+			// Returning false lets the loop handle a pause or stop request first.
+			if (m_requests.load(std::memory_order_relaxed) != 0)
+				return false;
+
+			m_isNotified.store(false, std::memory_order_relaxed);
+			return true;
+		}
+
+		bool waitForDeadline()
+		{
+			using Clock = std::chrono::steady_clock;
 
-						WriteLock write(m_mutex);
-						m_state = State::Paused;
-						write.unlock();
+			Clock::time_point now = Clock::now();
+
+			if (!m_isDeadlineSet)
+			{
+				m_deadline = now;
+				m_isDeadlineSet = true;
+			}
+			else
+			{
+				m_deadline += m_period;
+
+				// The previous repetition ended after this deadline.
+				if (now > m_deadline)
+				{
+					m_overrunCount.store(m_overrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
-						WAIT_FOR(getState() != State::Paused);
+					if (m_period.count() > 0)
+					{
+						std::int64_t missed = (now - m_deadline) / m_period;
+						m_deadline += missed * m_period;
+						m_skippedCount.store(m_skippedCount.load(std::memory_order_relaxed) + static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
 					}
 				}
+			}
 
-				// Loop script
-				m_onLoop();
+			// Sleep while far from the deadline. Waiting on the condition lets pause and stop requests interrupt it.
+			markIdle();
+
+			if (m_deadline - now > m_spinThreshold)
+			{
+				WriteLock write(m_mutex);
+
+				m_condition.wait_until(write, m_deadline - m_spinThreshold, [this] {
+					return m_requests.load(std::memory_order_relaxed) != 0;
+				});
+			}
+
+			Backoff backoff = m_backoff;
+
+			while ((now = Clock::now()) < m_deadline)
+			{
+				if (m_requests.load(std::memory_order_relaxed) != 0)
+					break;
+
+				backoff.pause(m_deadline - now);
+			}
+
+			if (m_requests.load(std::memory_order_relaxed) != 0)
+			{
+				// Deadlines start again once the request has been handled.
+				m_isDeadlineSet = false;
+				return false;
+			}
+
+			recordLateness(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_deadline).count());
+			return true;
+		}
+
+		void recordLateness(std::int64_t lateness)
+		{
+			// Only this thread writes the statistics, so plain stores are enough to publish them.
+			std::uint64_t tickCount = m_tickCount.load(std::memory_order_relaxed);
+
+			if (tickCount == 0 || lateness < m_minLateness.load(std::memory_order_relaxed))
+				m_minLateness.store(lateness, std::memory_order_relaxed);
+
+			if (lateness > m_maxLateness.load(std::memory_order_relaxed))
+				m_maxLateness.store(lateness, std::memory_order_relaxed);
+
+			m_latenessSum.store(m_latenessSum.load(std::memory_order_relaxed) + lateness, std::memory_order_relaxed);
+			m_tickCount.store(tickCount + 1, std::memory_order_relaxed);
+		}
+
+		void resetRateStats()
+		{
+			m_isDeadlineSet = false;
+			m_tickCount.store(0, std::memory_order_relaxed);
+			m_overrunCount.store(0, std::memory_order_relaxed);
+			m_skippedCount.store(0, std::memory_order_relaxed);
+			m_minLateness.store(0, std::memory_order_relaxed);
+			m_maxLateness.store(0, std::memory_order_relaxed);
+			m_latenessSum.store(0, std::memory_order_relaxed);
+		}
+
+		void recordIteration(std::int64_t time)
+		{
+			// Only this thread writes the statistics, so plain stores are enough to publish them.
+			std::uint64_t iterationCount = m_iterationCount.load(std::memory_order_relaxed);
+
+			if (iterationCount == 0 || time < m_minIterationTime.load(std::memory_order_relaxed))
+				m_minIterationTime.store(time, std::memory_order_relaxed);
+
+			if (time > m_maxIterationTime.load(std::memory_order_relaxed))
+				m_maxIterationTime.store(time, std::memory_order_relaxed);
+
+			std::size_t bucket = 0;
+
+			for (std::uint64_t remaining = static_cast<std::uint64_t>(time); remaining != 0 && bucket < histogramSize - 1; remaining >>= 1)
+				bucket++;
+
+			m_histogram[bucket].store(m_histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			m_iterationTimeSum.store(m_iterationTimeSum.load(std::memory_order_relaxed) + time, std::memory_order_relaxed);
+			m_iterationCount.store(iterationCount + 1, std::memory_order_relaxed);
+		}
+
+		void resetIterationStats()
+		{
+			m_iterationCount.store(0, std::memory_order_relaxed);
+			m_minIterationTime.store(0, std::memory_order_relaxed);
+			m_maxIterationTime.store(0, std::memory_order_relaxed);
+			m_iterationTimeSum.store(0, std::memory_order_relaxed);
+
+			for (auto& bucket : m_histogram)
+				bucket.store(0, std::memory_order_relaxed);
+		}
+
+		void markIdle()
+		{
+			if (m_heartbeat)
+				m_heartbeat->setIdle();
+		}
+
+		void waitWhilePaused()
+		{
+			// Resuming shortly after pausing is common, so poll a little before parking.
+			Backoff backoff = m_backoff;
+
+			while (!backoff.isSleeping())
+			{
+				if (getState() != State::Paused)
+					return;
+
+				backoff.pause();
 			}
+
+			WriteLock write(m_mutex);
+			m_condition.wait(write, [this] { return m_state.load(std::memory_order_relaxed) != State::Paused; });
 		}
 
 		void startThread()
 		{
-			m_state = State::Running;
-			m_thread.run(&LoopThread::threadLoop, this);
+			resetRateStats();
+			resetIterationStats();
+			m_state.store(State::Running, std::memory_order_release);
+			m_thread.run(&BasicLoopThread::threadLoop, this);
+
+			if (!m_affinity.empty())
+				m_thread.setAffinity(m_affinity);
+
+			if (!m_name.empty())
+				m_thread.setName(m_name);
+
+			if (m_hasScheduling)
+				m_thread.setScheduling(m_schedulingPolicy, m_schedulingPriority);
+		}
+
+		bool isThreadAlive() const
+		{
+			return (int)m_state.load(std::memory_order_relaxed) & ((int)State::Running | (int)State::Paused);
 		}
 
-		void resumeScript()
+		void restartThread(State state, unsigned int requests)
 		{
-			if (m_state == State::Paused)
+			// If the thread was busy while not supposed to stop.
+			if (((int)state & ((int)State::Running | (int)State::Paused)) && !(requests & s_stopRequest))
 			{
-				m_isPauseAsked = false;
-				m_state = State::Running;
+				m_requests.store(requests, std::memory_order_relaxed);
+				startThread();
 			}
 		}
 
+		void resumeScript()
+		{
+			m_requests.fetch_and(~s_pauseRequest, std::memory_order_release);
+
+			if (m_state.load(std::memory_order_relaxed) == State::Paused)
+				m_state.store(State::Running, std::memory_order_release);
+
+			// Also wakes a pause() still waiting for the thread to park, since the pause was cancelled.
+			m_condition.notify_all();
+		}
+
 		void stopScript()
 		{
-			m_isStopAsked = true;
+			m_requests.fetch_or(s_stopRequest, std::memory_order_release);
+			m_condition.notify_all();
 			resumeScript();
 		}
 
 
+		/// Bit of m_requests set when a pause is asked.
+		static constexpr unsigned int s_pauseRequest = 0b01;
+		/// Bit of m_requests set when a stop is asked.
+		static constexpr unsigned int s_stopRequest = 0b10;
+
 		Thread m_thread;
-		State m_state;
-		std::function<void()> m_onLoop;
-		mutable Mutex m_mutex;
-		bool m_isPauseAsked;
-		bool m_isStopAsked;
+
+		// Read at every repetition and written by the controlling threads, so kept away from the task and its captures.
+		alignas(cacheLineSize) std::atomic<State> m_state;
+		std::atomic<unsigned int> m_requests;
+
+		alignas(cacheLineSize) Task m_onLoop;
+		std::function<bool()> m_hasWork;
+		Heartbeat* m_heartbeat;
+		Backoff m_backoff;
+		Mode m_mode;
+
+		// Written by the notifying threads.
+		alignas(cacheLineSize) std::atomic<bool> m_isNotified;
+		std::atomic<bool> m_isWaitingForWork;
+
+		alignas(cacheLineSize) std::chrono::nanoseconds m_period;
+		std::chrono::nanoseconds m_spinThreshold;
+		std::chrono::steady_clock::time_point m_deadline;
+		bool m_isDeadlineSet;
+		std::atomic<std::uint64_t> m_tickCount;
+		std::atomic<std::uint64_t> m_overrunCount;
+		std::atomic<std::uint64_t> m_skippedCount;
+		std::atomic<std::int64_t> m_minLateness;
+		std::atomic<std::int64_t> m_maxLateness;
+		std::atomic<std::int64_t> m_latenessSum;
+
+		std::atomic<std::uint64_t> m_iterationCount;
+		std::atomic<std::int64_t> m_minIterationTime;
+		std::atomic<std::int64_t> m_maxIterationTime;
+		std::atomic<std::int64_t> m_iterationTimeSum;
+		std::array<std::atomic<std::uint64_t>, histogramSize> m_histogram;
+
+		std::vector<unsigned int> m_affinity;
+		std::string m_name;
+		bool m_hasScheduling;
+		int m_schedulingPolicy;
+		int m_schedulingPriority;
+		mutable Lockable m_mutex;
+		std::condition_variable_any m_condition;
 	};
 
+
+	/// @brief LoopThread storing its task in a std::function.
+	/// 
+	using LoopThread = BasicLoopThread<>;
+
 }
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/LoopThread.hpp"
+#include "SEL/Threads/Barrier.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Runs a task on several threads in lockstep phases.
+	///
+	/// Each repetition of the task is a phase: every worker runs the task once, then waits at a Barrier
+	/// until all of them are done before starting the next phase. Pause and stop requests are applied
+	/// between two phases, by all the workers at once.
+	/// The duration of the task on each worker is measured, which shows the load imbalance between them.
+	///
+	class LoopThreadGroup : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief State of the group, with the same meaning as for a LoopThread.
+		///
+		using State = LoopThread::State;
+
+		/// @brief Timing statistics of the phases since the group started.
+		///
+		struct PhaseStats
+		{
+			std::uint64_t phaseCount;					///< Number of phases completed.
+			std::chrono::nanoseconds lastPhaseTime;		///< Time between the end of the previous phase and the end of the last one.
+			std::chrono::nanoseconds meanPhaseTime;		///< Average time of a phase.
+			std::chrono::nanoseconds maxPhaseTime;		///< Longest phase.
+			std::chrono::nanoseconds meanImbalance;		///< Average difference between the slowest worker of a phase and the mean of the workers.
+		};
+
+
+		/// @brief Constructor. No thread is created until start() is called.
+		///
+		/// @param threadCount is the number of workers. It must not be 0.
+		/// @param function is the task run by every worker once per phase. It receives the index of the worker.
+		///
+		LoopThreadGroup(std::size_t threadCount, std::function<void(std::size_t)> function)
+			: m_function(std::move(function)), m_barrier(threadCount)
+		{
+			m_workers.reserve(threadCount);
+
+			for (std::size_t i = 0; i < threadCount; i++)
+				m_workers.push_back(createScope<Worker>(i));
+		}
+
+		/// @brief Destructor that will call stop() and join() before deleting the instance.
+		///
+		~LoopThreadGroup()
+		{
+			join();
+		}
+
+
+		/// @brief Creates the worker threads and asks them to start running phases.
+		///
+		void start()
+		{
+			join();
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_requests.store(0, std::memory_order_relaxed);
+			m_command = 0;
+			resetStats();
+			m_state.store(State::Running, std::memory_order_release);
+
+			for (auto& worker : m_workers)
+				worker->thread.run(&LoopThreadGroup::workerLoop, this, worker.get());
+		}
+
+		/// @brief Asks and waits for the workers to stop at the end of the current phase, without terminating.
+		///
+		void pause()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			if (m_state.load(std::memory_order_relaxed) != State::Running)
+				return;
+
+			m_requests.fetch_or(s_pauseRequest, std::memory_order_release);
+
+			// A resume from another thread cancels the request.
+			m_condition.wait(lock, [this] {
+				return m_state.load(std::memory_order_relaxed) != State::Running || !(m_requests.load(std::memory_order_relaxed) & s_pauseRequest);
+			});
+		}
+
+		/// @brief Asks the workers to start running phases again if the group was in a pause state.
+		///
+		void resume()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			resumeScript();
+		}
+
+		/// @brief Asks the workers to stop at the end of the current phase.
+		///
+		void stop()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_requests.fetch_or(s_stopRequest, std::memory_order_release);
+			m_condition.notify_all();
+		}
+
+		/// @brief Stops the workers and waits for them to finish their execution.
+		///
+		/// @return The value indicating if the method could wait for the workers.
+		///
+		bool join()
+		{
+			stop();
+
+			bool success = false;
+
+			for (auto& worker : m_workers)
+				success |= worker->thread.join();
+
+			if (success)
+				m_state.store(State::Joined, std::memory_order_release);
+
+			return success;
+		}
+
+
+		/// @return The group's state.
+		///
+		State getState() const
+		{
+			return m_state.load(std::memory_order_acquire);
+		}
+
+		/// @return The number of workers.
+		///
+		std::size_t getThreadCount() const { return m_workers.size(); }
+
+		/// @return The timing statistics of the phases. It can be called from any thread.
+		///
+		PhaseStats getPhaseStats() const
+		{
+			PhaseStats stats;
+
+			stats.phaseCount = m_phaseCount.load(std::memory_order_relaxed);
+			stats.lastPhaseTime = std::chrono::nanoseconds(m_lastPhaseTime.load(std::memory_order_relaxed));
+			stats.maxPhaseTime = std::chrono::nanoseconds(m_maxPhaseTime.load(std::memory_order_relaxed));
+			stats.meanPhaseTime = std::chrono::nanoseconds(stats.phaseCount ? m_phaseTimeSum.load(std::memory_order_relaxed) / (std::int64_t)stats.phaseCount : 0);
+			stats.meanImbalance = std::chrono::nanoseconds(stats.phaseCount ? m_imbalanceSum.load(std::memory_order_relaxed) / (std::int64_t)stats.phaseCount : 0);
+
+			return stats;
+		}
+
+		/// @param index is the index of the worker.
+		///
+		/// @return The time the worker spent running the task during the last phase.
+		///
+		std::chrono::nanoseconds getWorkerLastTime(std::size_t index) const
+		{
+			return std::chrono::nanoseconds(m_workers[index]->lastTime.load(std::memory_order_relaxed));
+		}
+
+		/// @param index is the index of the worker.
+		///
+		/// @return The time the worker spent running the task since the group started. The rest of the time was spent waiting for the other workers.
+		///
+		std::chrono::nanoseconds getWorkerBusyTime(std::size_t index) const
+		{
+			return std::chrono::nanoseconds(m_workers[index]->busyTime.load(std::memory_order_relaxed));
+		}
+
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		// Each worker writes its own timings, so they are kept on separate cache lines.
+		struct alignas(cacheLineSize) Worker
+		{
+			explicit Worker(std::size_t workerIndex)
+				: index(workerIndex) {}
+
+			std::size_t index;
+			std::atomic<std::int64_t> lastTime = 0;
+			std::atomic<std::int64_t> busyTime = 0;
+			Thread thread;
+		};
+
+
+		void workerLoop(Worker* worker)
+		{
+			while (true)
+			{
+				Clock::time_point start = Clock::now();
+				m_function(worker->index);
+				std::int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+				// Only this worker writes its timings, so plain stores are enough to publish them.
+				worker->lastTime.store(duration, std::memory_order_relaxed);
+				worker->busyTime.store(worker->busyTime.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+
+				m_barrier.arriveAndWait([this] { completePhase(); });
+
+				// The command was decided by the last worker to arrive, so every worker takes the same decision.
+				if (m_command & s_stopRequest)
+					break;
+
+				if ((m_command & s_pauseRequest) && !waitWhilePaused())
+					break;
+			}
+		}
+
+		void completePhase()
+		{
+			// Run by the last worker to arrive while the others wait, so a single thread writes at a time.
+			Clock::time_point now = Clock::now();
+			std::int64_t phaseTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_phaseStart).count();
+			std::int64_t slowest = 0;
+			std::int64_t sum = 0;
+
+			for (auto& worker : m_workers)
+			{
+				std::int64_t time = worker->lastTime.load(std::memory_order_relaxed);
+
+				slowest = std::max(slowest, time);
+				sum += time;
+			}
+
+			m_phaseStart = now;
+			m_lastPhaseTime.store(phaseTime, std::memory_order_relaxed);
+			m_maxPhaseTime.store(std::max(m_maxPhaseTime.load(std::memory_order_relaxed), phaseTime), std::memory_order_relaxed);
+			m_phaseTimeSum.store(m_phaseTimeSum.load(std::memory_order_relaxed) + phaseTime, std::memory_order_relaxed);
+			m_imbalanceSum.store(m_imbalanceSum.load(std::memory_order_relaxed) + slowest - sum / (std::int64_t)m_workers.size(), std::memory_order_relaxed);
+			m_phaseCount.store(m_phaseCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			// While nothing is asked, a single relaxed load is paid per phase.
+			if (m_requests.load(std::memory_order_relaxed) == 0)
+			{
+				m_command = 0;
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_command = m_requests.load(std::memory_order_relaxed);
+
+			if (m_command & s_stopRequest)
+				m_state.store(State::Stopped, std::memory_order_release);
+			else if (m_command & s_pauseRequest)
+			{
+				m_pausedGeneration = m_resumeGeneration;
+				m_state.store(State::Paused, std::memory_order_release);
+			}
+
+			m_condition.notify_all();
+		}
+
+		bool waitWhilePaused()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			// A resume and a stop are both decided under the mutex, so every worker sees the same one first.
+			m_condition.wait(lock, [this] {
+				return m_resumeGeneration != m_pausedGeneration || (m_requests.load(std::memory_order_relaxed) & s_stopRequest);
+			});
+
+			return m_resumeGeneration != m_pausedGeneration;
+		}
+
+		void resumeScript()
+		{
+			if (m_requests.load(std::memory_order_relaxed) & s_stopRequest)
+				return;
+
+			m_requests.fetch_and(~s_pauseRequest, std::memory_order_release);
+
+			if (m_state.load(std::memory_order_relaxed) == State::Paused)
+			{
+				// The paused time does not count in the next phase.
+				m_phaseStart = Clock::now();
+				m_resumeGeneration++;
+				m_state.store(State::Running, std::memory_order_release);
+			}
+
+			m_condition.notify_all();
+		}
+
+		void resetStats()
+		{
+			m_phaseStart = Clock::now();
+			m_phaseCount.store(0, std::memory_order_relaxed);
+			m_lastPhaseTime.store(0, std::memory_order_relaxed);
+			m_maxPhaseTime.store(0, std::memory_order_relaxed);
+			m_phaseTimeSum.store(0, std::memory_order_relaxed);
+			m_imbalanceSum.store(0, std::memory_order_relaxed);
+
+			for (auto& worker : m_workers)
+			{
+				worker->lastTime.store(0, std::memory_order_relaxed);
+				worker->busyTime.store(0, std::memory_order_relaxed);
+			}
+		}
+
+
+		/// Bit of m_requests set when a pause is asked.
+		static constexpr unsigned int s_pauseRequest = 0b01;
+		/// Bit of m_requests set when a stop is asked.
+		static constexpr unsigned int s_stopRequest = 0b10;
+
+		std::function<void(std::size_t)> m_function;
+		std::vector<Scope<Worker>> m_workers;
+		Barrier m_barrier;
+
+		std::atomic<State> m_state = State::None;
+		std::atomic<unsigned int> m_requests = s_stopRequest;
+		unsigned int m_command = 0;
+		std::uint64_t m_resumeGeneration = 0;
+		std::uint64_t m_pausedGeneration = 0;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+
+		Clock::time_point m_phaseStart;
+		std::atomic<std::uint64_t> m_phaseCount = 0;
+		std::atomic<std::int64_t> m_lastPhaseTime = 0;
+		std::atomic<std::int64_t> m_maxPhaseTime = 0;
+		std::atomic<std::int64_t> m_phaseTimeSum = 0;
+		std::atomic<std::int64_t> m_imbalanceSum = 0;
+	};
+
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace sel {
+
+	/// @brief Bounded lock-free queue for any number of producer and consumer threads.
+	///
+	/// This is Dmitry Vyukov's array queue: each cell holds a sequence number telling whether it is
+	/// ready to be written or read for a given position, so producers and consumers only contend on
+	/// their own position counter and on the cell they claimed.
+	/// The try methods never block. The blocking ones spin for a short while, then park until
+	/// a consumer or a producer of the other side makes progress.
+	///
+	/// @tparam T is the type of the stored elements.
+	///
+	template <class T>
+	class MpmcQueue : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param capacity is the minimum number of elements the queue can hold. It is rounded up to a power of two of at least 2.
+		///
+		explicit MpmcQueue(std::size_t capacity)
+		{
+			m_capacity = 2;
+
+			while (m_capacity < capacity)
+				m_capacity <<= 1;
+
+			m_mask = m_capacity - 1;
+			m_cells = new Cell[m_capacity];
+
+			for (std::size_t i = 0; i < m_capacity; i++)
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		/// @brief Destructor that destroys the elements left in the queue.
+		///
+		~MpmcQueue()
+		{
+			std::size_t enqueued = m_enqueuePosition.load(std::memory_order_acquire);
+
+			for (std::size_t i = m_dequeuePosition.load(std::memory_order_relaxed); i != enqueued; i++)
+				std::launder(reinterpret_cast<T*>(&m_cells[i & m_mask].storage))->~T();
+
+			delete[] m_cells;
+		}
+
+
+		/// @brief Constructs an element in place at the back of the queue if there is room for it.
+		///
+		/// @tparam ...Args are the types of the arguments for the element constructor.
+		/// @param ...args are the arguments for the element constructor. They are left untouched if false is returned.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		template <class ...Args>
+		bool tryEmplace(Args&&... args)
+		{
+			if (!emplace(std::forward<Args>(args)...))
+				return false;
+
+			wake(m_waitingConsumers, m_notEmpty);
+			return true;
+		}
+
+		/// @brief Adds an element at the back of the queue if there is room for it.
+		///
+		/// @param element is the element being pushed.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		bool tryPush(const T& element) { return tryEmplace(element); }
+
+		/// @brief Adds an element at the back of the queue if there is room for it.
+		///
+		/// @param element is the element being pushed. It is left untouched if false is returned.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		bool tryPush(T&& element) { return tryEmplace(std::move(element)); }
+
+		/// @brief Removes the element at the front of the queue if there is one.
+		///
+		/// @param element is where the removed element is moved.
+		///
+		/// @return The value indicating if an element could be removed.
+		///
+		bool tryPop(T& element)
+		{
+			if (!extract(element))
+				return false;
+
+			wake(m_waitingProducers, m_notFull);
+			return true;
+		}
+
+
+		/// @brief Adds an element at the back of the queue, waiting for room if it is full.
+		///
+		/// @param element is the element being pushed.
+		///
+		void push(T element)
+		{
+			for (unsigned int i = 0; i < s_spinCount; i++)
+			{
+				if (tryPush(std::move(element)))
+					return;
+
+				std::this_thread::yield();
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_waitingProducers.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			// The element is pushed with the mutex locked, so consumers are woken once it is released.
+			m_notFull.wait(lock, [&] { return emplace(std::move(element)); });
+			m_waitingProducers.fetch_sub(1, std::memory_order_relaxed);
+			lock.unlock();
+
+			wake(m_waitingConsumers, m_notEmpty);
+		}
+
+		/// @brief Removes the element at the front of the queue, waiting for one if it is empty.
+		///
+		/// @param element is where the removed element is moved.
+		///
+		void pop(T& element)
+		{
+			for (unsigned int i = 0; i < s_spinCount; i++)
+			{
+				if (tryPop(element))
+					return;
+
+				std::this_thread::yield();
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_waitingConsumers.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			m_notEmpty.wait(lock, [&] { return extract(element); });
+			m_waitingConsumers.fetch_sub(1, std::memory_order_relaxed);
+			lock.unlock();
+
+			wake(m_waitingProducers, m_notFull);
+		}
+
+
+		/// @return The approximate number of elements in the queue. It may be outdated right away.
+		///
+		std::size_t getSize() const
+		{
+			std::size_t dequeued = m_dequeuePosition.load(std::memory_order_relaxed);
+			std::size_t enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+
+			return enqueued > dequeued ? enqueued - dequeued : 0;
+		}
+
+		/// @return The value indicating if the queue seemed empty when called.
+		///
+		bool isEmpty() const { return getSize() == 0; }
+
+		/// @return The maximum number of elements the queue can hold.
+		///
+		std::size_t getCapacity() const { return m_capacity; }
+
+
+	private:
+
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;
+			std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+		};
+
+		template <class ...Args>
+		bool emplace(Args&&... args)
+		{
+			std::size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+			Cell* cell;
+
+			while (true)
+			{
+				cell = &m_cells[position & m_mask];
+				std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+				if (difference == 0)
+				{
+					if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					return false;
+				else
+					position = m_enqueuePosition.load(std::memory_order_relaxed);
+			}
+
+			::new (static_cast<void*>(&cell->storage)) T(std::forward<Args>(args)...);
+			cell->sequence.store(position + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		bool extract(T& element)
+		{
+			std::size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+			Cell* cell;
+
+			while (true)
+			{
+				cell = &m_cells[position & m_mask];
+				std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+				if (difference == 0)
+				{
+					if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					return false;
+				else
+					position = m_dequeuePosition.load(std::memory_order_relaxed);
+			}
+
+			T* stored = std::launder(reinterpret_cast<T*>(&cell->storage));
+			element = std::move(*stored);
+			stored->~T();
+			cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		void wake(std::atomic<std::size_t>& waitingCount, std::condition_variable& condition)
+		{
+			// Pairs with the fence in push() and pop(): either the waiter is seen or it sees the change.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (waitingCount.load(std::memory_order_relaxed) == 0)
+				return;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+			}
+
+			condition.notify_one();
+		}
+
+
+		/// Number of attempts the blocking methods make before parking.
+		static constexpr unsigned int s_spinCount = 64;
+
+		alignas(cacheLineSize) std::atomic<std::size_t> m_enqueuePosition = 0;
+		alignas(cacheLineSize) std::atomic<std::size_t> m_dequeuePosition = 0;
+
+		alignas(cacheLineSize) Cell* m_cells;
+		std::size_t m_capacity;
+		std::size_t m_mask;
+
+		alignas(cacheLineSize) std::atomic<std::size_t> m_waitingProducers = 0;
+		std::atomic<std::size_t> m_waitingConsumers = 0;
+		std::mutex m_mutex;
+		std::condition_variable m_notEmpty;
+		std::condition_variable m_notFull;
+	};
+
+}
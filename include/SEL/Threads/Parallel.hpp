@@ -0,0 +1,258 @@
+#pragma once
+
+#include "SEL/Threads/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <type_traits>
+
+
+namespace sel {
+
+	namespace utils {
+
+		/// @brief Names a type in a non-deduced context, so that an argument converts to it instead of taking part in the deduction.
+		///
+		template <class T>
+		struct TypeIdentity
+		{
+			using type = T;
+		};
+
+		template <class T>
+		using NonDeduced = typename TypeIdentity<T>::type;
+
+		/// @brief Task that runs a callable owned by a waiting thread and flags its completion.
+		///
+		template <class Fn>
+		class ForkTask : public PoolTask
+		{
+		public:
+
+			explicit ForkTask(Fn& function)
+				: m_function(function) {}
+
+			void execute() override
+			{
+				try
+				{
+					m_function();
+				}
+				catch (...)
+				{
+					m_exception = std::current_exception();
+				}
+
+				// Nothing may touch the task after this store since its owner may return right away.
+				m_isDone.store(true, std::memory_order_release);
+			}
+
+			bool isDone() const { return m_isDone.load(std::memory_order_acquire); }
+
+			std::exception_ptr getException() const { return m_exception; }
+
+		private:
+
+			Fn& m_function;
+			std::exception_ptr m_exception;
+			std::atomic<bool> m_isDone = false;
+		};
+
+
+		/// @brief Runs two callables in parallel and waits for both of them.
+		///
+		/// The right callable is queued on the pool where it can be stolen while the calling thread runs the left one.
+		/// While waiting, the calling thread helps the pool run its tasks.
+		///
+		/// @param pool is the pool the right callable is queued on.
+		/// @param left is the callable run by the calling thread.
+		/// @param right is the callable queued on the pool.
+		///
+		template <class Left, class Right>
+		void forkJoin(ThreadPool& pool, Left&& left, Right&& right)
+		{
+			ForkTask<std::remove_reference_t<Right>> task(right);
+			pool.execute(&task);
+
+			std::exception_ptr exception;
+
+			try
+			{
+				left();
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			// The task lives on this stack frame, so it must have run before returning.
+			while (!task.isDone())
+			{
+				if (!pool.runPendingTask())
+					std::this_thread::yield();
+			}
+
+			if (!exception)
+				exception = task.getException();
+
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+
+
+		template <class Index>
+		Index chooseGrain(const ThreadPool& pool, Index begin, Index end, Index grain)
+		{
+			if (grain > 0)
+				return grain;
+
+			// Around eight chunks per worker leave room for balancing uneven work.
+			// Computed in std::size_t, since the chunk count may not fit in a narrow index type.
+			std::size_t chunkCount = std::max<std::size_t>(1, static_cast<std::size_t>(pool.getThreadCount()) * 8);
+			std::size_t size = static_cast<std::size_t>(end - begin);
+
+			// Never bigger than the range size, so it fits in Index.
+			return static_cast<Index>(std::max<std::size_t>(1, size / chunkCount));
+		}
+
+		template <class Index, class Fn>
+		void parallelForRange(ThreadPool& pool, Index begin, Index end, Index grain, Fn& function)
+		{
+			if (end - begin > grain)
+			{
+				Index middle = begin + (end - begin) / 2;
+
+				forkJoin(pool,
+					[&] { parallelForRange(pool, begin, middle, grain, function); },
+					[&] { parallelForRange(pool, middle, end, grain, function); }
+				);
+			}
+			else
+			{
+				for (Index i = begin; i < end; i++)
+					function(i);
+			}
+		}
+
+		template <class Index, class T, class Fn, class Combine>
+		T parallelReduceRange(ThreadPool& pool, Index begin, Index end, Index grain, const T& identity, Fn& function, Combine& combine)
+		{
+			if (end - begin > grain)
+			{
+				Index middle = begin + (end - begin) / 2;
+				T left = identity;
+				T right = identity;
+
+				forkJoin(pool,
+					[&] { left = parallelReduceRange(pool, begin, middle, grain, identity, function, combine); },
+					[&] { right = parallelReduceRange(pool, middle, end, grain, identity, function, combine); }
+				);
+
+				return combine(left, right);
+			}
+
+			T result = identity;
+
+			for (Index i = begin; i < end; i++)
+				result = combine(result, function(i));
+
+			return result;
+		}
+
+	}
+
+
+	/// @brief Calls a function for every index of a range, in parallel.
+	///
+	/// The range is split in halves recursively until the pieces are no bigger than the grain.
+	/// Halves are queued on the pool so that idle workers can steal them, which balances uneven work.
+	/// The calling thread takes part in the work and returns once every index has been processed.
+	///
+	/// @tparam Index is an integral type, deduced from end only. begin and grain are converted to it.
+	/// @tparam Fn is a callable type taking an index.
+	/// @param pool is the pool running the loop.
+	/// @param begin is the first index.
+	/// @param end is the index after the last one.
+	/// @param grain is the maximum number of indices processed sequentially. If 0, it is chosen from the range size and the worker count.
+	/// @param function is the callable object.
+	///
+	template <class Index, class Fn>
+	void parallelFor(ThreadPool& pool, utils::NonDeduced<Index> begin, Index end, utils::NonDeduced<Index> grain, Fn&& function)
+	{
+		if (begin >= end)
+			return;
+
+		grain = utils::chooseGrain(pool, begin, end, grain);
+		utils::parallelForRange(pool, begin, end, grain, function);
+	}
+
+	/// @brief Calls a function for every index of a range, in parallel on the shared pool.
+	///
+	/// @tparam Index is an integral type, deduced from end only. begin and grain are converted to it.
+	/// @tparam Fn is a callable type taking an index.
+	/// @param begin is the first index.
+	/// @param end is the index after the last one.
+	/// @param grain is the maximum number of indices processed sequentially. If 0, it is chosen automatically.
+	/// @param function is the callable object.
+	///
+	template <class Index, class Fn>
+	void parallelFor(utils::NonDeduced<Index> begin, Index end, utils::NonDeduced<Index> grain, Fn&& function)
+	{
+		parallelFor(ThreadPool::getShared(), begin, end, grain, std::forward<Fn>(function));
+	}
+
+
+	/// @brief Combines the values computed for every index of a range, in parallel.
+	///
+	/// The range is split the same way as in parallelFor(). The combine operation must be associative
+	/// and identity must be its neutral element, since pieces are combined in an unspecified grouping.
+	///
+	/// @tparam Index is an integral type, deduced from end only. begin and grain are converted to it.
+	/// @tparam T is the type of the result.
+	/// @tparam Fn is a callable type taking an index and returning a value convertible to T.
+	/// @tparam Combine is a callable type taking two T values and returning their combination.
+	/// @param pool is the pool running the loop.
+	/// @param begin is the first index.
+	/// @param end is the index after the last one.
+	/// @param grain is the maximum number of indices processed sequentially. If 0, it is chosen from the range size and the worker count.
+	/// @param identity is the neutral element of the combine operation.
+	/// @param function is the callable computing the value of an index.
+	/// @param combine is the callable combining two values.
+	///
+	/// @return The combination of every computed value, or identity if the range is empty.
+	///
+	template <class Index, class T, class Fn, class Combine>
+	T parallelReduce(ThreadPool& pool, utils::NonDeduced<Index> begin, Index end, utils::NonDeduced<Index> grain, T identity, Fn&& function, Combine&& combine)
+	{
+		if (begin >= end)
+			return identity;
+
+		grain = utils::chooseGrain(pool, begin, end, grain);
+		return utils::parallelReduceRange(pool, begin, end, grain, identity, function, combine);
+	}
+
+	/// @brief Combines the values computed for every index of a range, in parallel on the shared pool.
+	///
+	/// @tparam Index is an integral type, deduced from end only. begin and grain are converted to it.
+	/// @tparam T is the type of the result.
+	/// @tparam Fn is a callable type taking an index and returning a value convertible to T.
+	/// @tparam Combine is a callable type taking two T values and returning their combination.
+	/// @param begin is the first index.
+	/// @param end is the index after the last one.
+	/// @param grain is the maximum number of indices processed sequentially. If 0, it is chosen automatically.
+	/// @param identity is the neutral element of the combine operation.
+	/// @param function is the callable computing the value of an index.
+	/// @param combine is the callable combining two values.
+	///
+	/// @return The combination of every computed value, or identity if the range is empty.
+	///
+	template <class Index, class T, class Fn, class Combine>
+	T parallelReduce(utils::NonDeduced<Index> begin, Index end, utils::NonDeduced<Index> grain, T identity, Fn&& function, Combine&& combine)
+	{
+		return parallelReduce(ThreadPool::getShared(), begin, end, grain, identity, std::forward<Fn>(function), std::forward<Combine>(combine));
+	}
+
+}
@@ -0,0 +1,498 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/LoopThread.hpp"
+#include "SEL/Threads/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <unordered_map>
+
+
+namespace sel {
+
+	/// @brief Runs many periodic and one-shot tasks on a small fixed set of threads.
+	///
+	/// Tasks are kept in a hierarchical timing wheel, so scheduling, pausing and cancelling a task are O(1)
+	/// whatever the number of tasks. A timer thread advances the wheel one tick at a time and hands due
+	/// tasks to a ThreadPool owned by the scheduler.
+	/// A periodic task never runs concurrently with itself: if it is still running when it is due again,
+	/// that occurrence is skipped and counted as an overrun.
+	///
+	class PeriodicScheduler : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Identifies a task of the scheduler.
+		///
+		using TaskId = std::uint64_t;
+
+		/// @brief State of a task, with the same meaning as for a LoopThread.
+		///
+		/// None is returned for tasks that are unknown, finished or cancelled.
+		///
+		using State = LoopThread::State;
+
+
+		/// @brief Constructor that starts the timer thread and the workers.
+		///
+		/// @param threadCount is the number of threads running the tasks.
+		/// @param tick is the resolution of the timing wheel. Delays and periods are rounded up to a multiple of it.
+		///
+		explicit PeriodicScheduler(std::size_t threadCount = 2, std::chrono::nanoseconds tick = std::chrono::milliseconds(1))
+			: m_tick(tick), m_start(Clock::now()), m_random(std::random_device{}()), m_pool(threadCount)
+		{
+			for (auto& level : m_wheel)
+				for (auto& slot : level)
+					slot = nullptr;
+
+			m_timerThread.run(&PeriodicScheduler::timerLoop, this);
+		}
+
+		/// @brief Destructor that stops the timer thread then waits for the running tasks.
+		///
+		~PeriodicScheduler()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_isStopping = true;
+			}
+
+			m_timerCondition.notify_one();
+			m_timerThread.join();
+		}
+
+
+		/// @brief Schedules a task that runs once per period.
+		///
+		/// @param function is the task. It must not throw.
+		/// @param period is the time between two runs.
+		/// @param jitter is the maximum random delay added to each run, to avoid many tasks running at the same tick.
+		///
+		/// @return The identifier of the task.
+		///
+		TaskId schedulePeriodic(std::function<void()> function, std::chrono::nanoseconds period, std::chrono::nanoseconds jitter = std::chrono::nanoseconds(0))
+		{
+			return add(std::move(function), period, period, jitter, false);
+		}
+
+		/// @brief Schedules a task that runs once after a delay.
+		///
+		/// @param function is the task. It must not throw.
+		/// @param delay is the time before the task runs.
+		///
+		/// @return The identifier of the task.
+		///
+		TaskId scheduleOnce(std::function<void()> function, std::chrono::nanoseconds delay)
+		{
+			return add(std::move(function), delay, std::chrono::nanoseconds(0), std::chrono::nanoseconds(0), true);
+		}
+
+		/// @brief Asks and waits for a task to stop being run, without cancelling it.
+		///
+		/// It must not be called from the task itself.
+		///
+		/// @param id is the identifier of the task.
+		///
+		/// @return The value indicating if the task exists.
+		///
+		bool pause(TaskId id)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			Entry* entry = find(id);
+
+			if (!entry)
+				return false;
+
+			if (entry->state == State::Running)
+			{
+				entry->state = State::Paused;
+				unlink(*entry);
+			}
+
+			// A one-shot task is erased once it has run, so the entry is looked up again.
+			m_idleCondition.wait(lock, [this, id] { Entry* current = find(id); return !current || !current->isExecuting; });
+
+			return true;
+		}
+
+		/// @brief Runs a paused task again. Periodic tasks start a new period from now.
+		///
+		/// @param id is the identifier of the task.
+		///
+		/// @return The value indicating if the task exists.
+		///
+		bool resume(TaskId id)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			Entry* entry = find(id);
+
+			if (!entry)
+				return false;
+
+			if (entry->state == State::Paused)
+			{
+				catchUp();
+				entry->state = State::Running;
+
+				if (entry->isOneShot)
+					link(*entry, std::max(entry->expiry, m_now + 1));
+				else
+				{
+					entry->base = m_now;
+					scheduleNext(*entry);
+				}
+
+				lock.unlock();
+				m_timerCondition.notify_one();
+			}
+
+			return true;
+		}
+
+		/// @brief Cancels a task. If it is running, it finishes its current run.
+		///
+		/// @param id is the identifier of the task.
+		///
+		/// @return The value indicating if the task existed.
+		///
+		bool cancel(TaskId id)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			Entry* entry = find(id);
+
+			if (!entry)
+				return false;
+
+			unlink(*entry);
+			entry->state = State::Stopped;
+
+			// A running task is erased by its worker once it has finished.
+			if (!entry->isExecuting)
+				m_entries.erase(id);
+
+			return true;
+		}
+
+
+		/// @param id is the identifier of the task.
+		///
+		/// @return The state of the task.
+		///
+		State getState(TaskId id) const
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto it = m_entries.find(id);
+
+			return it == m_entries.end() ? State::None : it->second->state;
+		}
+
+		/// @param id is the identifier of the task.
+		///
+		/// @return The number of runs of the task that were skipped because the previous one was still running.
+		///
+		std::uint64_t getOverrunCount(TaskId id) const
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto it = m_entries.find(id);
+
+			return it == m_entries.end() ? 0 : it->second->overrunCount;
+		}
+
+		/// @return The number of tasks in the scheduler.
+		///
+		std::size_t getTaskCount() const
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			return m_entries.size();
+		}
+
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		struct Entry : public PoolTask
+		{
+			void execute() override { scheduler->run(*this); }
+
+			PeriodicScheduler* scheduler;
+			TaskId id;
+			std::function<void()> function;
+			std::uint64_t periodTicks;
+			std::uint64_t jitterTicks;
+			std::uint64_t base;
+			std::uint64_t expiry;
+			std::uint64_t overrunCount = 0;
+			State state = State::Running;
+			bool isOneShot;
+			bool isExecuting = false;
+
+			// Intrusive list of the wheel slot holding the entry.
+			Entry** slot = nullptr;
+			Entry* previous = nullptr;
+			Entry* next = nullptr;
+		};
+
+
+		TaskId add(std::function<void()> function, std::chrono::nanoseconds delay, std::chrono::nanoseconds period, std::chrono::nanoseconds jitter, bool isOneShot)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			catchUp();
+
+			TaskId id = m_nextId++;
+			Scope<Entry> entry = createScope<Entry>();
+
+			entry->scheduler = this;
+			entry->id = id;
+			entry->function = std::move(function);
+			entry->periodTicks = std::max<std::uint64_t>(1, toTicks(period));
+			entry->jitterTicks = toTicks(jitter);
+			entry->isOneShot = isOneShot;
+			entry->base = m_now + toTicks(delay) - (isOneShot ? 0 : entry->periodTicks);
+
+			Entry& added = *entry;
+			m_entries.emplace(id, std::move(entry));
+
+			if (isOneShot)
+				link(added, std::max(added.base, m_now + 1));
+			else
+				scheduleNext(added);
+
+			lock.unlock();
+			m_timerCondition.notify_one();
+
+			return id;
+		}
+
+		Entry* find(TaskId id)
+		{
+			auto it = m_entries.find(id);
+
+			return it == m_entries.end() ? nullptr : it->second.get();
+		}
+
+		void catchUp()
+		{
+			// The wheel stops advancing while it is empty.
+			if (m_linkedCount == 0)
+				m_now = std::max(m_now, currentTick());
+		}
+
+		std::uint64_t toTicks(std::chrono::nanoseconds duration) const
+		{
+			if (duration.count() <= 0)
+				return 0;
+
+			return static_cast<std::uint64_t>((duration.count() + m_tick.count() - 1) / m_tick.count());
+		}
+
+		std::uint64_t currentTick() const
+		{
+			return static_cast<std::uint64_t>((Clock::now() - m_start) / m_tick);
+		}
+
+		void scheduleNext(Entry& entry)
+		{
+			entry.base += entry.periodTicks;
+
+			// Occurrences missed while the scheduler was late are dropped.
+			if (entry.base <= m_now)
+				entry.base += ((m_now - entry.base) / entry.periodTicks + 1) * entry.periodTicks;
+
+			std::uint64_t jitter = 0;
+
+			if (entry.jitterTicks > 0)
+				jitter = std::uniform_int_distribution<std::uint64_t>(0, entry.jitterTicks)(m_random);
+
+			link(entry, entry.base + jitter);
+		}
+
+		void link(Entry& entry, std::uint64_t expiry)
+		{
+			entry.expiry = expiry;
+
+			// Cascaded entries due now go to the level 0 slot about to fire.
+			std::uint64_t delta = expiry > m_now ? expiry - m_now : 0;
+			std::uint64_t position = m_now + delta;
+			std::size_t level = 0;
+
+			while (level < s_levelCount - 1 && delta >= (std::uint64_t(1) << ((level + 1) * s_slotBits)))
+				level++;
+
+			// Expiries beyond the wheel range wait in the farthest slot and are placed again once cascaded.
+			if (delta >= (std::uint64_t(1) << (s_levelCount * s_slotBits)))
+				position = m_now + (std::uint64_t(1) << (s_levelCount * s_slotBits)) - 1;
+
+			Entry** slot = &m_wheel[level][(position >> (level * s_slotBits)) & s_slotMask];
+
+			entry.slot = slot;
+			entry.previous = nullptr;
+			entry.next = *slot;
+
+			if (*slot)
+				(*slot)->previous = &entry;
+
+			*slot = &entry;
+			m_linkedCount++;
+		}
+
+		void unlink(Entry& entry)
+		{
+			if (!entry.slot)
+				return;
+
+			if (entry.previous)
+				entry.previous->next = entry.next;
+			else
+				*entry.slot = entry.next;
+
+			if (entry.next)
+				entry.next->previous = entry.previous;
+
+			entry.slot = nullptr;
+			entry.previous = nullptr;
+			entry.next = nullptr;
+			m_linkedCount--;
+		}
+
+		Entry* detachSlot(Entry** slot)
+		{
+			Entry* first = *slot;
+
+			for (Entry* entry = first; entry; entry = entry->next)
+			{
+				entry->slot = nullptr;
+				m_linkedCount--;
+			}
+
+			*slot = nullptr;
+			return first;
+		}
+
+		void advance()
+		{
+			m_now++;
+
+			// When the lower levels wrap around, the matching slot of the level above is spread over them.
+			for (std::size_t level = 1; level < s_levelCount; level++)
+			{
+				if ((m_now & ((std::uint64_t(1) << (level * s_slotBits)) - 1)) != 0)
+					break;
+
+				Entry* entry = detachSlot(&m_wheel[level][(m_now >> (level * s_slotBits)) & s_slotMask]);
+
+				while (entry)
+				{
+					Entry* next = entry->next;
+					link(*entry, entry->expiry);
+					entry = next;
+				}
+			}
+
+			Entry* entry = detachSlot(&m_wheel[0][m_now & s_slotMask]);
+
+			while (entry)
+			{
+				Entry* next = entry->next;
+				entry->previous = nullptr;
+				entry->next = nullptr;
+				fire(*entry);
+				entry = next;
+			}
+		}
+
+		void fire(Entry& entry)
+		{
+			if (entry.isExecuting)
+				entry.overrunCount++;
+			else
+			{
+				entry.isExecuting = true;
+				m_pool.execute(&entry);
+			}
+
+			if (!entry.isOneShot)
+				scheduleNext(entry);
+		}
+
+		void run(Entry& entry)
+		{
+			entry.function();
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			entry.isExecuting = false;
+
+			// A one-shot task that has run is over, even if it was paused meanwhile.
+			if (entry.isOneShot)
+				entry.state = State::Stopped;
+
+			// The entry is destroyed here, so it must not be touched afterwards.
+			if (entry.state == State::Stopped)
+				m_entries.erase(entry.id);
+
+			lock.unlock();
+			m_idleCondition.notify_all();
+		}
+
+		void timerLoop()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			while (!m_isStopping)
+			{
+				if (m_linkedCount == 0)
+				{
+					m_timerCondition.wait(lock);
+					continue;
+				}
+
+				std::uint64_t target = currentTick();
+
+				while (m_now < target && m_linkedCount > 0)
+					advance();
+
+				m_timerCondition.wait_until(lock, m_start + m_tick * static_cast<std::int64_t>(m_now + 1));
+			}
+		}
+
+
+		/// Number of bits of the tick used to index the slots of a level.
+		static constexpr std::size_t s_slotBits = 6;
+		static constexpr std::size_t s_slotCount = std::size_t(1) << s_slotBits;
+		static constexpr std::uint64_t s_slotMask = s_slotCount - 1;
+		/// With 6 bits per level, 4 levels cover 2^24 ticks, more than 4 hours with 1ms ticks.
+		static constexpr std::size_t s_levelCount = 4;
+
+		std::chrono::nanoseconds m_tick;
+		Clock::time_point m_start;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_timerCondition;
+		std::condition_variable m_idleCondition;
+		Entry* m_wheel[s_levelCount][s_slotCount];
+		std::uint64_t m_now = 0;
+		std::size_t m_linkedCount = 0;
+		std::unordered_map<TaskId, Scope<Entry>> m_entries;
+		TaskId m_nextId = 1;
+		std::mt19937_64 m_random;
+		bool m_isStopping = false;
+
+		Thread m_timerThread;
+		// Destroyed first, so that tasks still queued or running can access the members above.
+		ThreadPool m_pool;
+	};
+
+}
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/Backoff.hpp"
+#include "SEL/Threads/MpmcQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Statistics of a stage of a Pipeline.
+	///
+	struct PipelineStageStats
+	{
+		std::string name;							///< Name given to the stage.
+		std::size_t workerCount;					///< Number of workers of the stage.
+		std::uint64_t processedCount;				///< Number of elements processed since the pipeline started.
+		double throughput;							///< Elements processed per second since the pipeline started.
+		std::size_t queueDepth;						///< Approximate number of elements waiting in the input queue of the stage.
+		std::size_t queueCapacity;					///< Capacity of the input queue of the stage.
+		std::chrono::nanoseconds blockedTime;		///< Time the workers spent waiting for room in the next queue, summed over the workers.
+	};
+
+
+	namespace utils {
+
+		class PipelineStageBase
+		{
+		public:
+
+			virtual ~PipelineStageBase() = default;
+
+			virtual void start(std::chrono::steady_clock::time_point startTime) = 0;
+			virtual void join() = 0;
+			virtual void closeInput() = 0;
+			virtual bool isFinished() const = 0;
+			virtual PipelineStageStats getStats() const = 0;
+
+			void setNext(PipelineStageBase* next) { m_next = next; }
+
+		protected:
+
+			PipelineStageBase* m_next = nullptr;
+		};
+
+		template <class I, class O, class Fn>
+		class PipelineStage : public PipelineStageBase
+		{
+			// Workers pop into an element they own, as MpmcQueue::tryPop() requires.
+			static_assert(std::is_default_constructible_v<I>, "The elements given to a pipeline stage must be default constructible.");
+			static_assert(std::is_void_v<O> || std::is_default_constructible_v<O>, "The elements produced by a pipeline stage must be default constructible.");
+
+		public:
+
+			using Output = std::conditional_t<std::is_void_v<O>, char, O>;
+
+			PipelineStage(MpmcQueue<I>* input, Fn function, std::string name, std::size_t workerCount, std::size_t capacity, const Backoff& idleBackoff)
+				: m_input(input), m_function(std::move(function)), m_name(std::move(name)), m_idleBackoff(idleBackoff)
+			{
+				if constexpr (!std::is_void_v<O>)
+					m_output = createScope<MpmcQueue<O>>(capacity);
+
+				m_workers.reserve(workerCount);
+
+				for (std::size_t i = 0; i < workerCount; i++)
+					m_workers.push_back(createScope<Worker>());
+			}
+
+			~PipelineStage()
+			{
+				join();
+			}
+
+			void start(std::chrono::steady_clock::time_point startTime) override
+			{
+				m_startTime = startTime;
+				m_isInputClosed.store(false, std::memory_order_relaxed);
+				m_activeCount.store(m_workers.size(), std::memory_order_relaxed);
+
+				for (auto& worker : m_workers)
+				{
+					worker->processedCount.store(0, std::memory_order_relaxed);
+					worker->blockedTime.store(0, std::memory_order_relaxed);
+					worker->thread.run(&PipelineStage::workerLoop, this, worker.get());
+				}
+			}
+
+			void join() override
+			{
+				for (auto& worker : m_workers)
+					worker->thread.join();
+			}
+
+			void closeInput() override
+			{
+				m_isInputClosed.store(true, std::memory_order_release);
+			}
+
+			bool isFinished() const override
+			{
+				return m_activeCount.load(std::memory_order_acquire) == 0;
+			}
+
+			PipelineStageStats getStats() const override
+			{
+				PipelineStageStats stats;
+
+				stats.name = m_name;
+				stats.workerCount = m_workers.size();
+				stats.processedCount = 0;
+				stats.blockedTime = std::chrono::nanoseconds(0);
+
+				for (auto& worker : m_workers)
+				{
+					stats.processedCount += worker->processedCount.load(std::memory_order_relaxed);
+					stats.blockedTime += std::chrono::nanoseconds(worker->blockedTime.load(std::memory_order_relaxed));
+				}
+
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_startTime;
+
+				stats.throughput = elapsed.count() > 0 ? stats.processedCount / elapsed.count() : 0;
+				stats.queueDepth = m_input->getSize();
+				stats.queueCapacity = m_input->getCapacity();
+
+				return stats;
+			}
+
+			MpmcQueue<Output>* getOutput() { return m_output.get(); }
+
+		private:
+
+			// Each worker writes its own statistics, so they are kept on separate cache lines.
+			struct alignas(cacheLineSize) Worker
+			{
+				std::atomic<std::uint64_t> processedCount = 0;
+				std::atomic<std::int64_t> blockedTime = 0;
+				Thread thread;
+			};
+
+			void workerLoop(Worker* worker)
+			{
+				Backoff backoff = m_idleBackoff;
+				I element;
+
+				while (true)
+				{
+					if (m_input->tryPop(element))
+					{
+						backoff.reset();
+						process(*worker, std::move(element));
+					}
+					// The previous stage closes the input once it has pushed its last element, so one more look is needed.
+					else if (m_isInputClosed.load(std::memory_order_acquire))
+					{
+						if (!m_input->tryPop(element))
+							break;
+
+						process(*worker, std::move(element));
+					}
+					else
+						backoff.pause();
+				}
+
+				// The last worker to finish closes the input of the next stage.
+				if (m_activeCount.fetch_sub(1, std::memory_order_acq_rel) == 1 && m_next)
+					m_next->closeInput();
+			}
+
+			void process(Worker& worker, I&& element)
+			{
+				if constexpr (std::is_void_v<O>)
+					m_function(std::move(element));
+				else
+				{
+					O result = m_function(std::move(element));
+
+					// Backpressure: a full queue blocks the stage until the next one catches up.
+					if (!m_output->tryPush(std::move(result)))
+					{
+						std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+						m_output->push(std::move(result));
+						std::int64_t blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+						worker.blockedTime.store(worker.blockedTime.load(std::memory_order_relaxed) + blocked, std::memory_order_relaxed);
+					}
+				}
+
+				// Only this worker writes its statistics, so plain stores are enough to publish them.
+				worker.processedCount.store(worker.processedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+
+			MpmcQueue<I>* m_input;
+			Scope<MpmcQueue<Output>> m_output;
+			Fn m_function;
+			std::string m_name;
+			Backoff m_idleBackoff;
+			std::vector<Scope<Worker>> m_workers;
+			std::atomic<bool> m_isInputClosed = false;
+			std::atomic<std::size_t> m_activeCount = 0;
+			std::chrono::steady_clock::time_point m_startTime;
+		};
+
+	}
+
+
+	/// @brief Chain of stages, each run by its own workers and connected to the next one by a bounded MpmcQueue.
+	///
+	/// The pipeline is built by calling then() for every stage, each stage transforming the output of the previous one.
+	/// A stage with several workers processes several elements at once, so it should not keep state between elements
+	/// and the order of its output is not guaranteed. When a stage is slower than the previous one, its input queue fills
+	/// up and the previous stage waits for room in it, which propagates the backpressure up to push().
+	/// Idle workers poll their input queue with a Backoff.
+	///
+	/// @code
+	/// auto pipeline = sel::Pipeline<Packet>(1024)
+	///     .then([](Packet packet) { return decode(packet); }, 1, "decode")
+	///     .then([](Message message) { return transform(message); }, 4, "transform")
+	///     .then([&](Result result) { aggregate(result); }, 1, "aggregate");
+	///
+	/// pipeline.start();
+	/// pipeline.push(packet);
+	/// pipeline.stop();
+	/// @endcode
+	///
+	/// @tparam In is the type of the elements pushed into the pipeline. Like the elements produced by every stage, it must be default constructible and movable.
+	/// @tparam Out is the type of the elements produced by the last stage, or void if it produces nothing.
+	///
+	template <class In, class Out = In>
+	class Pipeline : public NonCopyable
+	{
+	public:
+
+		/// @brief Statistics of a stage.
+		///
+		using StageStats = PipelineStageStats;
+
+
+		/// @brief Constructor of a pipeline without any stage.
+		///
+		/// @param capacity is the capacity of the input queue.
+		/// @param idleBackoff is how idle workers wait for elements.
+		///
+		explicit Pipeline(std::size_t capacity = 1024, const Backoff& idleBackoff = Backoff())
+			: m_source(createScope<MpmcQueue<In>>(capacity)), m_idleBackoff(idleBackoff)
+		{
+			static_assert(std::is_same_v<In, Out>, "A pipeline is created without any stage.");
+
+			m_tail = m_source.get();
+		}
+
+		/// @brief Move constructor.
+		///
+		/// @param other is the Pipeline object being moved. It must not be running.
+		///
+		Pipeline(Pipeline&& other) noexcept
+			: m_source(std::move(other.m_source)), m_stages(std::move(other.m_stages)), m_tail(std::exchange(other.m_tail, nullptr)),
+			m_idleBackoff(other.m_idleBackoff), m_isRunning(std::exchange(other.m_isRunning, false)) {}
+
+		/// @brief Destructor that waits for the elements already pushed to go through the pipeline.
+		///
+		/// The elements produced by the last stage and not popped are discarded, so that it cannot stay blocked on a full output queue.
+		///
+		~Pipeline()
+		{
+			drain(true);
+		}
+
+
+		/// @brief Adds a stage at the end of the pipeline. It must be called before start().
+		///
+		/// @tparam Fn is a callable type taking an Out element.
+		/// @param function is the function processing each element. It must not throw.
+		/// @param workerCount is the number of threads running the stage.
+		/// @param name is the name of the stage, useful to read statistics.
+		/// @param capacity is the capacity of the output queue of the stage.
+		///
+		/// @return The pipeline with the new stage. This one is left empty.
+		/// The elements returned by the function must be default constructible and movable.
+		///
+		template <class Fn>
+		auto then(Fn function, std::size_t workerCount = 1, std::string name = {}, std::size_t capacity = 1024) &&
+		{
+			static_assert(!std::is_void_v<Out>, "The last stage of the pipeline produces nothing.");
+
+			using R = std::invoke_result_t<Fn&, Out&&>;
+
+			auto stage = createScope<utils::PipelineStage<Out, R, Fn>>(m_tail, std::move(function), std::move(name), workerCount, capacity, m_idleBackoff);
+			Pipeline<In, R> next(std::move(m_source), std::move(m_stages), m_idleBackoff);
+
+			if (!next.m_stages.empty())
+				next.m_stages.back()->setNext(stage.get());
+
+			if constexpr (!std::is_void_v<R>)
+				next.m_tail = stage->getOutput();
+
+			next.m_stages.push_back(std::move(stage));
+			return next;
+		}
+
+
+		/// @brief Creates the workers of every stage.
+		///
+		void start()
+		{
+			stop();
+
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+			for (auto& stage : m_stages)
+				stage->start(startTime);
+
+			m_isRunning = true;
+		}
+
+		/// @brief Waits for every element pushed so far to go through the pipeline, then joins the workers.
+		///
+		/// If the last stage produces elements, they must be popped for the pipeline to be able to drain.
+		///
+		void stop()
+		{
+			drain(false);
+		}
+
+		/// @brief Pushes an element into the pipeline, waiting for room if the first stage is behind.
+		///
+		/// @param element is the element being pushed.
+		///
+		void push(In element)
+		{
+			m_source->push(std::move(element));
+		}
+
+		/// @brief Pushes an element into the pipeline if there is room for it.
+		///
+		/// @param element is the element being pushed. It is left untouched if false is returned.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		bool tryPush(In&& element)
+		{
+			return m_source->tryPush(std::move(element));
+		}
+
+		/// @brief Removes an element produced by the last stage if there is one.
+		///
+		/// @param element is where the removed element is moved.
+		///
+		/// @return The value indicating if an element could be removed.
+		///
+		template <class T = Out, class = std::enable_if_t<!std::is_void_v<T>>>
+		bool tryPop(T& element)
+		{
+			return m_tail->tryPop(element);
+		}
+
+		/// @brief Removes an element produced by the last stage, waiting for one if there is none.
+		///
+		/// @param element is where the removed element is moved.
+		///
+		template <class T = Out, class = std::enable_if_t<!std::is_void_v<T>>>
+		void pop(T& element)
+		{
+			m_tail->pop(element);
+		}
+
+
+		/// @return The number of stages.
+		///
+		std::size_t getStageCount() const { return m_stages.size(); }
+
+		/// @param index is the index of the stage, in the order they were added.
+		///
+		/// @return The statistics of the stage. It can be called from any thread.
+		///
+		StageStats getStageStats(std::size_t index) const
+		{
+			return m_stages[index]->getStats();
+		}
+
+
+	private:
+
+		template <class, class>
+		friend class Pipeline;
+
+		Pipeline(Scope<MpmcQueue<In>> source, std::vector<Scope<utils::PipelineStageBase>> stages, const Backoff& idleBackoff)
+			: m_source(std::move(source)), m_stages(std::move(stages)), m_idleBackoff(idleBackoff) {}
+
+
+		void drain(bool isOutputDiscarded)
+		{
+			if (!m_isRunning || m_stages.empty())
+				return;
+
+			m_stages.front()->closeInput();
+
+			if constexpr (!std::is_void_v<Out>)
+			{
+				if (isOutputDiscarded)
+				{
+					Out element;
+
+					// The earlier stages finish first, since each one feeds the next.
+					while (!m_stages.back()->isFinished())
+					{
+						if (!m_tail->tryPop(element))
+							std::this_thread::yield();
+					}
+				}
+			}
+
+			for (auto& stage : m_stages)
+				stage->join();
+
+			m_isRunning = false;
+		}
+
+
+		Scope<MpmcQueue<In>> m_source;
+		std::vector<Scope<utils::PipelineStageBase>> m_stages;
+		MpmcQueue<std::conditional_t<std::is_void_v<Out>, char, Out>>* m_tail = nullptr;
+		Backoff m_idleBackoff;
+		bool m_isRunning = false;
+	};
+
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/Backoff.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+namespace sel {
+
+	/// @brief Sequence lock for data that is read often and written rarely.
+	///
+	/// Readers never write to shared memory: they read a sequence number, read the data, then check
+	/// that the sequence number did not change. If a writer was active meanwhile, they read again.
+	/// Readers thus never slow down each other nor the writers, but the data they read may be torn
+	/// and must only be used once the read is validated. See SeqLocked for a safe wrapper.
+	///
+	/// Writers exclude each other and can use WriteLock-style locks such as std::unique_lock<SeqLock>.
+	///
+	class SeqLock : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Default constructor. The lock is unlocked.
+		///
+		SeqLock() = default;
+
+
+		/// @brief Starts writing, waiting for the other writers.
+		///
+		void lock()
+		{
+			Backoff backoff;
+			std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+			while ((sequence & 1) || !m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				backoff.pause();
+				sequence = m_sequence.load(std::memory_order_relaxed);
+			}
+
+			// Acquiring the lock orders this writer after the previous one. The fence keeps the writes of the data
+			// from becoming visible before the odd sequence number.
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		/// @brief Starts writing if no other writer is active.
+		///
+		/// @return The value indicating if the lock was taken.
+		///
+		bool try_lock()
+		{
+			std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+			if ((sequence & 1) || !m_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return false;
+
+			std::atomic_thread_fence(std::memory_order_release);
+			return true;
+		}
+
+		/// @brief Ends writing.
+		///
+		void unlock()
+		{
+			m_sequence.fetch_add(1, std::memory_order_release);
+		}
+
+
+		/// @brief Starts reading, waiting for an active writer to finish.
+		///
+		/// @return The sequence number to give to validate().
+		///
+		std::uint64_t beginRead() const
+		{
+			Backoff backoff;
+			std::uint64_t sequence;
+
+			while ((sequence = m_sequence.load(std::memory_order_acquire)) & 1)
+				backoff.pause();
+
+			return sequence;
+		}
+
+		/// @brief Ends reading.
+		///
+		/// @param sequence is the value returned by beginRead().
+		///
+		/// @return The value indicating if the data read since beginRead() is consistent. If false, it must be read again.
+		///
+		bool validate(std::uint64_t sequence) const
+		{
+			// Keeps the reads of the data from moving after the check.
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			return m_sequence.load(std::memory_order_relaxed) == sequence;
+		}
+
+		/// @brief Calls a function until it has read consistent data.
+		///
+		/// The function may be called with data being written, so it must only read with atomic operations,
+		/// and must not act on what it read before the call returns.
+		///
+		/// @tparam Fn is a callable type.
+		/// @param function is the function reading the data.
+		///
+		template <class Fn>
+		void read(Fn&& function) const
+		{
+			std::uint64_t sequence;
+
+			do
+			{
+				sequence = beginRead();
+				function();
+			} while (!validate(sequence));
+		}
+
+
+	private:
+
+		std::atomic<std::uint64_t> m_sequence = 0;
+	};
+
+
+	/// @brief Value protected by a SeqLock, which readers copy without ever writing to shared memory.
+	///
+	/// The value is stored as atomic words, so copying it while it is being written is well defined.
+	/// It suits small values read much more often than they are written, such as configurations or poses.
+	///
+	/// @tparam T is the type of the value. It must be trivially copyable.
+	///
+	template <class T>
+	class SeqLocked : public NonCopyable, public NonMovable
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "A SeqLocked value must be trivially copyable.");
+
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param value is the initial value.
+		///
+		explicit SeqLocked(const T& value = T())
+		{
+			storeWords(value);
+		}
+
+
+		/// @return A consistent copy of the value.
+		///
+		T load() const
+		{
+			Words words;
+
+			m_lock.read([&] {
+				for (std::size_t i = 0; i < s_wordCount; i++)
+					words[i] = m_words[i].load(std::memory_order_relaxed);
+			});
+
+			T value;
+			std::memcpy(&value, words, sizeof(T));
+
+			return value;
+		}
+
+		/// @brief Replaces the value.
+		///
+		/// @param value is the new value.
+		///
+		void store(const T& value)
+		{
+			m_lock.lock();
+			storeWords(value);
+			m_lock.unlock();
+		}
+
+
+	private:
+
+		using Word = std::uintptr_t;
+
+		static constexpr std::size_t s_wordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+		using Words = Word[s_wordCount];
+
+		void storeWords(const T& value)
+		{
+			Words words = {};
+			std::memcpy(words, &value, sizeof(T));
+
+			for (std::size_t i = 0; i < s_wordCount; i++)
+				m_words[i].store(words[i], std::memory_order_relaxed);
+		}
+
+
+		SeqLock m_lock;
+		std::atomic<Word> m_words[s_wordCount];
+	};
+
+}
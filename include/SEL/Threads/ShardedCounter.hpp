@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+#include "SEL/Utilities/CachePadded.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+
+namespace sel {
+
+	/// @brief Counter that many threads can update at once without contending.
+	///
+	/// The count is split into shards, each on its own cache line, and each thread updates the shard
+	/// assigned to it. Updating is thus as cheap as for a counter private to the thread, while reading
+	/// sums every shard. It suits statistics updated far more often than they are read.
+	///
+	class ShardedCounter : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor. The count starts at 0.
+		///
+		/// @param shardCount is the number of shards. It is rounded up to a power of two. If 0, one shard per hardware thread is used.
+		///
+		explicit ShardedCounter(std::size_t shardCount = 0)
+		{
+			if (shardCount == 0)
+				shardCount = std::max(1u, std::thread::hardware_concurrency());
+
+			m_shardCount = 1;
+
+			while (m_shardCount < shardCount)
+				m_shardCount <<= 1;
+
+			m_shards = createScope<CachePadded<std::atomic<std::int64_t>>[]>(m_shardCount);
+		}
+
+
+		/// @brief Adds a value to the count.
+		///
+		/// @param value is the value being added.
+		///
+		void add(std::int64_t value)
+		{
+			// Threads may share a shard when there are more threads than shards, hence the atomic addition.
+			m_shards[utils::getThreadIndex() & (m_shardCount - 1)]->fetch_add(value, std::memory_order_relaxed);
+		}
+
+		/// @brief Adds 1 to the count.
+		///
+		void increment() { add(1); }
+
+		/// @brief Sums every shard.
+		///
+		/// Updates made during the call may or may not be counted.
+		///
+		/// @return The count.
+		///
+		std::int64_t get() const
+		{
+			std::int64_t sum = 0;
+
+			for (std::size_t i = 0; i < m_shardCount; i++)
+				sum += m_shards[i]->load(std::memory_order_relaxed);
+
+			return sum;
+		}
+
+		/// @brief Sets the count back to 0. Updates made during the call may be lost.
+		///
+		void reset()
+		{
+			for (std::size_t i = 0; i < m_shardCount; i++)
+				m_shards[i]->store(0, std::memory_order_relaxed);
+		}
+
+
+		/// @return The number of shards.
+		///
+		std::size_t getShardCount() const { return m_shardCount; }
+
+
+	private:
+
+		std::size_t m_shardCount;
+		Scope<CachePadded<std::atomic<std::int64_t>>[]> m_shards;
+	};
+
+}
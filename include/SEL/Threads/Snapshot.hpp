@@ -0,0 +1,134 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/EpochDomain.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+
+namespace sel {
+
+	/// @brief Holds the current version of read-mostly state, such as a configuration or a lookup table.
+	///
+	/// Versions are immutable once published. Readers access the current one in place, without locking nor
+	/// touching a reference count: with a guard of the domain already held, a read is a single acquire load.
+	/// Writers build the next version aside, then publish it by swapping a pointer, so they never block
+	/// the readers. The replaced version is retired to the domain and deleted after the readers still
+	/// using it unpin it.
+	///
+	/// A LoopThread can pin the domain once per iteration and read any number of snapshots with the same guard.
+	///
+	/// @tparam T is the type of the state.
+	///
+	template <class T>
+	class Snapshot : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param value is the first version.
+		/// @param domain is the domain in which replaced versions are retired.
+		///
+		explicit Snapshot(T value = T(), EpochDomain& domain = EpochDomain::getDefault())
+			: m_domain(domain), m_current(new T(std::move(value))) {}
+
+		/// @brief Destructor. The snapshot must no longer be read.
+		///
+		~Snapshot()
+		{
+			delete m_current.load(std::memory_order_acquire);
+		}
+
+
+		/// @brief Accesses the current version.
+		///
+		/// @param guard is a guard of the domain, which keeps the version alive.
+		///
+		/// @return The current version, valid as long as the guard exists.
+		///
+		const T& get(const EpochDomain::Guard& guard) const
+		{
+			(void)guard;
+
+			return *m_current.load(std::memory_order_acquire);
+		}
+
+		/// @brief Calls a function with the current version.
+		///
+		/// @tparam Fn is a callable type taking a const T&.
+		/// @param function is the function reading the version.
+		///
+		/// @return The value returned by the function.
+		///
+		template <class Fn>
+		decltype(auto) read(Fn&& function) const
+		{
+			EpochDomain::Guard guard = m_domain.pin();
+
+			return function(get(guard));
+		}
+
+		/// @return A copy of the current version.
+		///
+		T load() const
+		{
+			return read([](const T& value) { return value; });
+		}
+
+
+		/// @brief Publishes a new version.
+		///
+		/// @param value is the new version.
+		///
+		void store(T value)
+		{
+			std::lock_guard<std::mutex> lock(m_writeMutex);
+
+			publish(new T(std::move(value)));
+		}
+
+		/// @brief Publishes a version built from a copy of the current one.
+		///
+		/// Writers are serialized, so no update is lost. Readers keep reading the current version meanwhile.
+		///
+		/// @tparam Fn is a callable type taking a T&.
+		/// @param function is the function modifying the copy.
+		///
+		template <class Fn>
+		void update(Fn&& function)
+		{
+			std::lock_guard<std::mutex> lock(m_writeMutex);
+
+			Scope<T> next = createScope<T>(*m_current.load(std::memory_order_relaxed));
+			function(*next);
+
+			publish(next.release());
+		}
+
+
+		/// @return The domain in which versions are retired, to pin before calling get().
+		///
+		EpochDomain& getDomain() const { return m_domain; }
+
+
+	private:
+
+		void publish(T* next)
+		{
+			m_domain.retire(m_current.exchange(next, std::memory_order_acq_rel));
+		}
+
+
+		EpochDomain& m_domain;
+		std::atomic<T*> m_current;
+		std::mutex m_writeMutex;
+	};
+
+}
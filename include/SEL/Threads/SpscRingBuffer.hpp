@@ -0,0 +1,286 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+namespace sel {
+
+	/// @brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+	///
+	/// The producer and consumer indices live on separate cache lines. Each side also keeps a cached
+	/// copy of the other side's index, so it only reads the shared one when the cached value says the
+	/// buffer is full or empty. Batched operations publish their index once per batch.
+	///
+	/// @tparam T is the type of the stored elements.
+	///
+	template <class T>
+	class SpscRingBuffer : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param capacity is the minimum number of elements the buffer can hold. It is rounded up to a power of two.
+		///
+		explicit SpscRingBuffer(std::size_t capacity)
+		{
+			m_capacity = 1;
+
+			while (m_capacity < capacity)
+				m_capacity <<= 1;
+
+			m_mask = m_capacity - 1;
+			m_elements = static_cast<T*>(::operator new(sizeof(T) * m_capacity, std::align_val_t(alignof(T))));
+		}
+
+		/// @brief Destructor that destroys the elements left in the buffer.
+		///
+		~SpscRingBuffer()
+		{
+			std::size_t head = m_head.load(std::memory_order_acquire);
+
+			for (std::size_t i = m_tail.load(std::memory_order_relaxed); i != head; i++)
+				slot(i).~T();
+
+			::operator delete(m_elements, std::align_val_t(alignof(T)));
+		}
+
+
+		/// @brief Constructs an element in place at the back of the buffer. Must only be called by the producer.
+		///
+		/// @tparam ...Args are the types of the arguments for the element constructor.
+		/// @param ...args are the arguments for the element constructor.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		template <class ...Args>
+		bool tryEmplace(Args&&... args)
+		{
+			std::size_t head = m_head.load(std::memory_order_relaxed);
+
+			if (freeSlots(head, 1) == 0)
+				return false;
+
+			::new (static_cast<void*>(&slot(head))) T(std::forward<Args>(args)...);
+			m_head.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/// @brief Adds an element at the back of the buffer. Must only be called by the producer.
+		///
+		/// @param element is the element being pushed.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		bool tryPush(const T& element) { return tryEmplace(element); }
+
+		/// @brief Adds an element at the back of the buffer. Must only be called by the producer.
+		///
+		/// @param element is the element being pushed.
+		///
+		/// @return The value indicating if there was room for the element.
+		///
+		bool tryPush(T&& element) { return tryEmplace(std::move(element)); }
+
+		/// @brief Adds as many elements of a sequence as there is room for. Must only be called by the producer.
+		///
+		/// @tparam InputIt is an input iterator type.
+		/// @param first is the iterator to the first element to push.
+		/// @param count is the number of elements in the sequence.
+		///
+		/// @return The number of elements that were pushed, starting from the first one.
+		///
+		template <class InputIt>
+		std::size_t pushN(InputIt first, std::size_t count)
+		{
+			std::size_t head = m_head.load(std::memory_order_relaxed);
+			std::size_t pushed = std::min(count, freeSlots(head, count));
+
+			for (std::size_t i = 0; i < pushed; i++, ++first)
+				::new (static_cast<void*>(&slot(head + i))) T(*first);
+
+			m_head.store(head + pushed, std::memory_order_release);
+
+			return pushed;
+		}
+
+
+		/// @brief Removes the element at the front of the buffer. Must only be called by the consumer.
+		///
+		/// @param element is where the removed element is moved.
+		///
+		/// @return The value indicating if an element could be removed.
+		///
+		bool tryPop(T& element)
+		{
+			return popN(&element, 1) == 1;
+		}
+
+		/// @brief Removes up to the given number of elements from the front of the buffer. Must only be called by the consumer.
+		///
+		/// @tparam OutputIt is an output iterator type.
+		/// @param destination is where the removed elements are moved.
+		/// @param maxCount is the maximum number of elements to remove.
+		///
+		/// @return The number of elements that were removed.
+		///
+		template <class OutputIt>
+		std::size_t popN(OutputIt destination, std::size_t maxCount)
+		{
+			return consume([&destination](T& element) { *destination++ = std::move(element); }, maxCount);
+		}
+
+		/// @brief Processes elements in place at the front of the buffer then removes them. Must only be called by the consumer.
+		///
+		/// The elements are never copied or moved: the function is called with a reference to each of them inside the buffer.
+		/// The slots are handed back to the producer once the whole batch has been processed.
+		/// The function must not throw.
+		///
+		/// @tparam Fn is a callable type taking a T&.
+		/// @param function is the callable object.
+		/// @param maxCount is the maximum number of elements to process.
+		///
+		/// @return The number of elements that were processed.
+		///
+		template <class Fn>
+		std::size_t consume(Fn&& function, std::size_t maxCount = static_cast<std::size_t>(-1))
+		{
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			std::size_t count = std::min(maxCount, usedSlots(tail, maxCount));
+
+			for (std::size_t i = 0; i < count; i++)
+			{
+				T& element = slot(tail + i);
+				function(element);
+				element.~T();
+			}
+
+			if (count > 0)
+				m_tail.store(tail + count, std::memory_order_release);
+
+			return count;
+		}
+
+		/// @return The element at the front of the buffer, or nullptr if it is empty. Must only be called by the consumer.
+		///
+		T* front()
+		{
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+			return usedSlots(tail, 1) > 0 ? &slot(tail) : nullptr;
+		}
+
+		/// @brief Removes the element at the front of the buffer, which must exist. Must only be called by the consumer.
+		///
+		void pop()
+		{
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+			slot(tail).~T();
+			m_tail.store(tail + 1, std::memory_order_release);
+		}
+
+
+		/// @return The number of elements in the buffer when called. It may be outdated right away.
+		///
+		std::size_t getSize() const
+		{
+			std::size_t tail = m_tail.load(std::memory_order_acquire);
+			std::size_t head = m_head.load(std::memory_order_acquire);
+
+			return head - tail;
+		}
+
+		/// @return The value indicating if the buffer was empty when called.
+		///
+		bool isEmpty() const { return getSize() == 0; }
+
+		/// @return The maximum number of elements the buffer can hold.
+		///
+		std::size_t getCapacity() const { return m_capacity; }
+
+
+	private:
+
+		T& slot(std::size_t index) const
+		{
+			return *std::launder(m_elements + (index & m_mask));
+		}
+
+		/// The consumer's index is only read when the cached one does not leave room for the wanted number of elements.
+		std::size_t freeSlots(std::size_t head, std::size_t wanted)
+		{
+			std::size_t free = m_capacity - (head - m_cachedTail);
+
+			if (free < wanted)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				free = m_capacity - (head - m_cachedTail);
+			}
+
+			return free;
+		}
+
+		/// The producer's index is only read when the cached one does not give the wanted number of elements.
+		std::size_t usedSlots(std::size_t tail, std::size_t wanted)
+		{
+			std::size_t used = m_cachedHead - tail;
+
+			if (used < wanted)
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				used = m_cachedHead - tail;
+			}
+
+			return used;
+		}
+
+
+		// Written by the producer.
+		alignas(cacheLineSize) std::atomic<std::size_t> m_head = 0;
+		std::size_t m_cachedTail = 0;
+
+		// Written by the consumer.
+		alignas(cacheLineSize) std::atomic<std::size_t> m_tail = 0;
+		std::size_t m_cachedHead = 0;
+
+		// Read-only once constructed.
+		alignas(cacheLineSize) T* m_elements;
+		std::size_t m_capacity;
+		std::size_t m_mask;
+	};
+
+
+	/// @brief Makes a LoopThread task that processes a batch of elements of a buffer at each repetition.
+	///
+	/// Combined with the event-driven mode of LoopThread and a work predicate checking that the buffer
+	/// is not empty, the consumer sleeps while there is nothing to process.
+	///
+	/// @tparam T is the type of the buffer elements.
+	/// @tparam Fn is a callable type taking a T&.
+	/// @param buffer is the buffer being consumed. It must outlive the task.
+	/// @param maxBatch is the maximum number of elements processed per repetition.
+	/// @param function is the callable processing each element in place.
+	///
+	/// @return The task to give to the LoopThread.
+	///
+	template <class T, class Fn>
+	auto makeConsumerTask(SpscRingBuffer<T>& buffer, std::size_t maxBatch, Fn function)
+	{
+		return [&buffer, maxBatch, function = std::move(function)]() mutable
+		{
+			buffer.consume(function, maxBatch);
+		};
+	}
+
+}
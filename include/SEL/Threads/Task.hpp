@@ -0,0 +1,622 @@
+#pragma once
+
+// Coroutine tasks require C++20.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/ThreadPool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace sel {
+
+	template <class T = void>
+	class Task;
+
+	namespace utils {
+
+		class TaskPromiseBase
+		{
+		public:
+
+			struct FinalAwaiter
+			{
+				bool await_ready() noexcept { return false; }
+
+				template <class Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+				{
+					// Resumes the awaiting coroutine directly, without growing the stack.
+					std::coroutine_handle<> continuation = handle.promise().m_continuation;
+
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() noexcept {}
+			};
+
+			std::suspend_always initial_suspend() noexcept { return {}; }
+
+			FinalAwaiter final_suspend() noexcept { return {}; }
+
+			void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+			void setContinuation(std::coroutine_handle<> continuation) { m_continuation = continuation; }
+
+		protected:
+
+			void rethrowIfFailed()
+			{
+				if (m_exception)
+					std::rethrow_exception(m_exception);
+			}
+
+		private:
+
+			std::coroutine_handle<> m_continuation;
+			std::exception_ptr m_exception;
+		};
+
+		template <class T>
+		class TaskPromise : public TaskPromiseBase
+		{
+		public:
+
+			Task<T> get_return_object() noexcept;
+
+			template <class U>
+			void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+
+			T result()
+			{
+				rethrowIfFailed();
+
+				return std::move(*m_value);
+			}
+
+		private:
+
+			std::optional<T> m_value;
+		};
+
+		template <>
+		class TaskPromise<void> : public TaskPromiseBase
+		{
+		public:
+
+			Task<void> get_return_object() noexcept;
+
+			void return_void() noexcept {}
+
+			void result() { rethrowIfFailed(); }
+		};
+
+		// Coroutine that starts right away and destroys itself once finished.
+		struct DetachedCoroutine
+		{
+			struct promise_type
+			{
+				DetachedCoroutine get_return_object() noexcept { return {}; }
+				std::suspend_never initial_suspend() noexcept { return {}; }
+				std::suspend_never final_suspend() noexcept { return {}; }
+				void return_void() noexcept {}
+				void unhandled_exception() noexcept { std::terminate(); }
+			};
+		};
+
+	}
+
+
+	/// @brief Lazily started coroutine producing a value of type T.
+	///
+	/// The coroutine starts when the task is awaited with co_await, given to TaskScheduler::spawn()
+	/// or to syncWait(). It resumes its awaiter once finished. An exception escaping the coroutine is
+	/// rethrown to the awaiter. A task can only be awaited once.
+	///
+	/// @tparam T is the type of the value produced by the coroutine.
+	///
+	template <class T>
+	class Task : public NonCopyable
+	{
+	public:
+
+		using promise_type = utils::TaskPromise<T>;
+
+		/// @brief Move constructor.
+		///
+		/// @param other is the Task object being moved.
+		///
+		Task(Task&& other) noexcept
+			: m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+		/// @brief Destructor that destroys the coroutine frame.
+		///
+		~Task()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		/// @brief Move assignment operator.
+		///
+		/// @param other is the Task object being moved.
+		///
+		/// @return The assigned Task object.
+		///
+		Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_handle)
+					m_handle.destroy();
+
+				m_handle = std::exchange(other.m_handle, nullptr);
+			}
+
+			return *this;
+		}
+
+
+		/// @brief Starts the coroutine and suspends the awaiting one until it is finished.
+		///
+		/// @return The awaiter giving the value produced by the coroutine.
+		///
+		auto operator co_await() noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle<promise_type> handle;
+
+				bool await_ready() noexcept { return !handle || handle.done(); }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+				{
+					handle.promise().setContinuation(awaiting);
+					return handle;
+				}
+
+				T await_resume() { return handle.promise().result(); }
+			};
+
+			return Awaiter{ m_handle };
+		}
+
+
+	private:
+
+		friend class utils::TaskPromise<T>;
+
+		explicit Task(std::coroutine_handle<promise_type> handle)
+			: m_handle(handle) {}
+
+
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+
+	namespace utils {
+
+		template <class T>
+		Task<T> TaskPromise<T>::get_return_object() noexcept
+		{
+			return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+		}
+
+		inline Task<void> TaskPromise<void>::get_return_object() noexcept
+		{
+			return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+		}
+
+	}
+
+
+	/// @brief Runs a task and blocks the calling thread until it is finished.
+	///
+	/// @tparam T is the type of the value produced by the task.
+	/// @param task is the task being run.
+	///
+	/// @return The value produced by the task. An exception escaping the task is rethrown.
+	///
+	template <class T>
+	T syncWait(Task<T> task)
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool isDone = false;
+
+		// The result can only be taken once from the task, so the waiter keeps it.
+		std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+		std::exception_ptr exception;
+
+		auto waiter = [&]() -> utils::DetachedCoroutine
+		{
+			try
+			{
+				if constexpr (std::is_void_v<T>)
+					co_await task;
+				else
+					value.emplace(co_await task);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			// Notifying with the mutex locked keeps the waiting thread from returning before the notification is done.
+			std::unique_lock<std::mutex> lock(mutex);
+			isDone = true;
+			condition.notify_one();
+		};
+
+		waiter();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&] { return isDone; });
+
+		if (exception)
+			std::rethrow_exception(exception);
+
+		if constexpr (!std::is_void_v<T>)
+			return std::move(*value);
+	}
+
+
+	/// @brief Runs coroutines on the workers of a ThreadPool.
+	///
+	/// Coroutines move to the pool by awaiting schedule(), and go back to it after yield() or sleepFor().
+	/// Suspended coroutines do not use any thread: thousands of them can be in flight on a handful of workers.
+	/// A timer thread owned by the scheduler wakes the sleeping ones. The scheduler must outlive every coroutine using it.
+	///
+	class TaskScheduler : public NonCopyable, public NonMovable
+	{
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+	public:
+
+		/// @brief Awaitable resuming the awaiting coroutine on a worker of the pool.
+		///
+		class ScheduleAwaiter : public PoolTask
+		{
+		public:
+
+			ScheduleAwaiter(ThreadPool& pool, bool isYield)
+				: m_pool(pool), m_isYield(isYield) {}
+
+			bool await_ready() noexcept { return false; }
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				m_handle = handle;
+
+				// The coroutine may be resumed and this awaiter destroyed as soon as it is queued.
+				if (m_isYield)
+					m_pool.post(this);
+				else
+					m_pool.execute(this);
+			}
+
+			void await_resume() noexcept {}
+
+			void execute() override { m_handle.resume(); }
+
+		private:
+
+			ThreadPool& m_pool;
+			bool m_isYield;
+			std::coroutine_handle<> m_handle;
+		};
+
+		/// @brief Awaitable resuming the awaiting coroutine on a worker of the pool once a deadline is reached.
+		///
+		class SleepAwaiter : public PoolTask
+		{
+		public:
+
+			SleepAwaiter(TaskScheduler& scheduler, Clock::time_point deadline)
+				: m_scheduler(scheduler), m_deadline(deadline) {}
+
+			bool await_ready() noexcept { return Clock::now() >= m_deadline; }
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				m_handle = handle;
+				m_scheduler.addSleeper(this);
+			}
+
+			void await_resume() noexcept {}
+
+			void execute() override { m_handle.resume(); }
+
+		private:
+
+			friend class TaskScheduler;
+
+			TaskScheduler& m_scheduler;
+			Clock::time_point m_deadline;
+			std::coroutine_handle<> m_handle;
+		};
+
+
+		/// @brief Constructor that starts the timer thread.
+		///
+		/// @param pool is the pool running the coroutines.
+		///
+		explicit TaskScheduler(ThreadPool& pool = ThreadPool::getShared())
+			: m_pool(pool)
+		{
+			m_timerThread.run(&TaskScheduler::timerLoop, this);
+		}
+
+		/// @brief Destructor that stops the timer thread. Coroutines still sleeping are never resumed.
+		///
+		~TaskScheduler()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_timerMutex);
+				m_isStopping = true;
+			}
+
+			m_timerCondition.notify_one();
+			m_timerThread.join();
+		}
+
+
+		/// @return The awaitable moving the awaiting coroutine to a worker of the pool.
+		///
+		ScheduleAwaiter schedule() { return ScheduleAwaiter(m_pool, false); }
+
+		/// @return The awaitable letting the other queued work run before the awaiting coroutine is resumed.
+		///
+		ScheduleAwaiter yield() { return ScheduleAwaiter(m_pool, true); }
+
+		/// @param duration is how long the awaiting coroutine sleeps.
+		///
+		/// @return The awaitable resuming the awaiting coroutine on the pool after the given duration.
+		///
+		template <class Rep, class Period>
+		SleepAwaiter sleepFor(std::chrono::duration<Rep, Period> duration)
+		{
+			return SleepAwaiter(*this, Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+		}
+
+		/// @param deadline is when the awaiting coroutine wakes up.
+		///
+		/// @return The awaitable resuming the awaiting coroutine on the pool once the deadline is reached.
+		///
+		SleepAwaiter sleepUntil(Clock::time_point deadline)
+		{
+			return SleepAwaiter(*this, deadline);
+		}
+
+		/// @brief Runs a task on the pool without waiting for it.
+		///
+		/// The coroutine frame is destroyed once the task is finished. An exception escaping the task terminates the program.
+		///
+		/// @tparam T is the type of the value produced by the task, which is discarded.
+		/// @param task is the task being run.
+		///
+		template <class T>
+		void spawn(Task<T> task)
+		{
+			[](TaskScheduler& scheduler, Task<T> detached) -> utils::DetachedCoroutine
+			{
+				co_await scheduler.schedule();
+				co_await detached;
+			}(*this, std::move(task));
+		}
+
+		/// @return The pool running the coroutines.
+		///
+		ThreadPool& getPool() { return m_pool; }
+
+
+	private:
+
+		struct LaterDeadline
+		{
+			bool operator()(const SleepAwaiter* a, const SleepAwaiter* b) const { return a->m_deadline > b->m_deadline; }
+		};
+
+		void addSleeper(SleepAwaiter* sleeper)
+		{
+			bool isEarliest;
+
+			{
+				std::unique_lock<std::mutex> lock(m_timerMutex);
+
+				m_sleepers.push(sleeper);
+				isEarliest = m_sleepers.top() == sleeper;
+			}
+
+			if (isEarliest)
+				m_timerCondition.notify_one();
+		}
+
+		void timerLoop()
+		{
+			std::unique_lock<std::mutex> lock(m_timerMutex);
+
+			while (!m_isStopping)
+			{
+				if (m_sleepers.empty())
+				{
+					m_timerCondition.wait(lock);
+					continue;
+				}
+
+				SleepAwaiter* earliest = m_sleepers.top();
+
+				if (Clock::now() < earliest->m_deadline)
+				{
+					m_timerCondition.wait_until(lock, earliest->m_deadline);
+					continue;
+				}
+
+				m_sleepers.pop();
+				m_pool.execute(earliest);
+			}
+		}
+
+
+		ThreadPool& m_pool;
+
+		std::mutex m_timerMutex;
+		std::condition_variable m_timerCondition;
+		std::priority_queue<SleepAwaiter*, std::vector<SleepAwaiter*>, LaterDeadline> m_sleepers;
+		bool m_isStopping = false;
+		Thread m_timerThread;
+	};
+
+
+	/// @brief Unbounded queue whose consumers are coroutines that suspend while it is empty.
+	///
+	/// Awaiting pop() on an empty queue parks the coroutine without holding any thread. The next push()
+	/// hands its element directly to the longest waiting coroutine and resumes it on the pool.
+	/// Producers never block and can be coroutines or plain threads.
+	///
+	/// @tparam T is the type of the stored elements.
+	///
+	template <class T>
+	class AsyncQueue : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Awaitable giving the element at the front of the queue, once there is one.
+		///
+		class PopAwaiter : public PoolTask
+		{
+		public:
+
+			explicit PopAwaiter(AsyncQueue& queue)
+				: m_queue(queue) {}
+
+			bool await_ready() noexcept { return false; }
+
+			bool await_suspend(std::coroutine_handle<> handle)
+			{
+				m_handle = handle;
+
+				std::unique_lock<std::mutex> lock(m_queue.m_mutex);
+
+				if (!m_queue.m_elements.empty())
+				{
+					m_element.emplace(std::move(m_queue.m_elements.front()));
+					m_queue.m_elements.pop_front();
+
+					// Goes on without suspending.
+					return false;
+				}
+
+				m_queue.m_waiters.push_back(this);
+				return true;
+			}
+
+			T await_resume() { return std::move(*m_element); }
+
+			void execute() override { m_handle.resume(); }
+
+		private:
+
+			friend class AsyncQueue;
+
+			AsyncQueue& m_queue;
+			std::optional<T> m_element;
+			std::coroutine_handle<> m_handle;
+		};
+
+
+		/// @brief Constructor.
+		///
+		/// @param pool is the pool on which the waiting coroutines are resumed.
+		///
+		explicit AsyncQueue(ThreadPool& pool = ThreadPool::getShared())
+			: m_pool(pool) {}
+
+
+		/// @brief Adds an element at the back of the queue, or gives it to a waiting coroutine.
+		///
+		/// @param element is the element being added.
+		///
+		void push(T element)
+		{
+			PopAwaiter* waiter;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				if (m_waiters.empty())
+				{
+					m_elements.push_back(std::move(element));
+					return;
+				}
+
+				waiter = m_waiters.front();
+				m_waiters.pop_front();
+			}
+
+			waiter->m_element.emplace(std::move(element));
+			m_pool.execute(waiter);
+		}
+
+		/// @return The awaitable suspending the awaiting coroutine until an element is available, and giving it.
+		///
+		PopAwaiter pop() { return PopAwaiter(*this); }
+
+		/// @brief Takes the element at the front of the queue if there is one.
+		///
+		/// @param element is where the element is moved.
+		///
+		/// @return The value indicating if an element was taken.
+		///
+		bool tryPop(T& element)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			if (m_elements.empty())
+				return false;
+
+			element = std::move(m_elements.front());
+			m_elements.pop_front();
+
+			return true;
+		}
+
+		/// @return The number of elements in the queue.
+		///
+		std::size_t getSize() const
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			return m_elements.size();
+		}
+
+
+	private:
+
+		ThreadPool& m_pool;
+
+		mutable std::mutex m_mutex;
+		std::deque<T> m_elements;
+		std::deque<PopAwaiter*> m_waiters;
+	};
+
+}
+
+#endif
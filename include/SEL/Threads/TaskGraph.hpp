@@ -0,0 +1,311 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Directed acyclic graph of tasks that runs each task once all of its dependencies have finished.
+	///
+	/// The graph is built once and can then be run any number of times. The graph itself does not allocate
+	/// during a run: every node embeds the PoolTask queued on the pool, and the bookkeeping needed by a run,
+	/// including the storage of the critical path, is prepared the first time the graph is run after a modification.
+	/// The pool may still allocate while queuing the nodes, until its queues have grown to the size the graph
+	/// needs. Roots queued from a thread outside the pool go through its shared queue, which is a std::deque.
+	/// Each run also measures the duration of every node and finds the critical path, the chain of
+	/// dependent nodes that bounds the run time however many workers are available.
+	///
+	class TaskGraph : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Identifies a node of the graph.
+		///
+		using NodeId = std::size_t;
+
+		/// @brief Timing statistics of the last run of the graph.
+		///
+		struct RunStats
+		{
+			std::chrono::nanoseconds wallTime;				///< Time between the start and the end of the run.
+			std::chrono::nanoseconds workTime;				///< Sum of the durations of every node.
+			std::chrono::nanoseconds criticalPathTime;		///< Sum of the durations of the nodes of the critical path.
+			std::vector<NodeId> criticalPath;				///< Nodes of the critical path, in execution order.
+		};
+
+
+		/// @brief Default constructor. The graph is empty.
+		///
+		TaskGraph() = default;
+
+
+		/// @brief Adds a node to the graph.
+		///
+		/// @param function is the task run by the node.
+		/// @param name is the name of the node, useful to read statistics.
+		///
+		/// @return The identifier of the new node.
+		///
+		NodeId addNode(std::function<void()> function, std::string name = {})
+		{
+			m_nodes.push_back(createScope<Node>(this, m_nodes.size(), std::move(function), std::move(name)));
+			m_isPrepared = false;
+
+			return m_nodes.size() - 1;
+		}
+
+		/// @brief Makes a node wait for another one to finish before running.
+		///
+		/// @param before is the node that must finish first.
+		/// @param after is the node that depends on it.
+		///
+		void addDependency(NodeId before, NodeId after)
+		{
+			m_nodes[before]->successors.push_back(after);
+			m_nodes[after]->dependencyCount++;
+			m_isPrepared = false;
+		}
+
+
+		/// @brief Runs every node of the graph and waits for them to finish.
+		///
+		/// Ready nodes are queued on the pool and the calling thread helps running them.
+		/// If a node throws, the nodes depending on it still run and the first exception is rethrown once the run is over.
+		///
+		/// @param pool is the pool running the nodes.
+		///
+		/// @return The value indicating if the graph could run. False is returned if it has a cycle.
+		///
+		bool run(ThreadPool& pool = ThreadPool::getShared())
+		{
+			if (!m_isPrepared && !prepare())
+				return false;
+
+			if (m_nodes.empty())
+				return true;
+
+			m_pool = &pool;
+			m_exception = nullptr;
+			m_hasException.store(false, std::memory_order_relaxed);
+			m_remaining.store(m_nodes.size(), std::memory_order_relaxed);
+
+			for (auto& node : m_nodes)
+				node->pending.store(node->dependencyCount, std::memory_order_relaxed);
+
+			m_runStart = Clock::now();
+
+			for (NodeId root : m_roots)
+				pool.execute(&m_nodes[root]->task);
+
+			while (m_remaining.load(std::memory_order_acquire) > 0)
+			{
+				if (!pool.runPendingTask())
+					std::this_thread::yield();
+			}
+
+			computeStats(Clock::now());
+
+			if (m_exception)
+				std::rethrow_exception(m_exception);
+
+			return true;
+		}
+
+
+		/// @return The timing statistics of the last run.
+		///
+		const RunStats& getLastRunStats() const { return m_stats; }
+
+		/// @param node is the identifier of the node.
+		///
+		/// @return The duration of the node during the last run.
+		///
+		std::chrono::nanoseconds getNodeDuration(NodeId node) const
+		{
+			return m_nodes[node]->end - m_nodes[node]->start;
+		}
+
+		/// @param node is the identifier of the node.
+		///
+		/// @return The name of the node.
+		///
+		const std::string& getNodeName(NodeId node) const { return m_nodes[node]->name; }
+
+		/// @return The number of nodes in the graph.
+		///
+		std::size_t getNodeCount() const { return m_nodes.size(); }
+
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		class NodeTask : public PoolTask
+		{
+		public:
+
+			NodeTask(TaskGraph* graph, NodeId node)
+				: m_graph(graph), m_node(node) {}
+
+			void execute() override
+			{
+				m_graph->runNode(m_node);
+			}
+
+		private:
+
+			TaskGraph* m_graph;
+			NodeId m_node;
+		};
+
+		struct Node
+		{
+			Node(TaskGraph* graph, NodeId id, std::function<void()> nodeFunction, std::string nodeName)
+				: function(std::move(nodeFunction)), name(std::move(nodeName)), task(graph, id) {}
+
+			std::function<void()> function;
+			std::string name;
+			std::vector<NodeId> successors;
+			std::size_t dependencyCount = 0;
+			std::atomic<std::size_t> pending = 0;
+			NodeTask task;
+			Clock::time_point start;
+			Clock::time_point end;
+			std::chrono::nanoseconds longestPath;
+		};
+
+
+		bool prepare()
+		{
+			// Kahn's algorithm, which also detects cycles.
+			std::vector<std::size_t> remaining(m_nodes.size());
+
+			m_order.clear();
+			m_roots.clear();
+
+			for (NodeId i = 0; i < m_nodes.size(); i++)
+			{
+				remaining[i] = m_nodes[i]->dependencyCount;
+
+				if (remaining[i] == 0)
+				{
+					m_roots.push_back(i);
+					m_order.push_back(i);
+				}
+			}
+
+			for (std::size_t i = 0; i < m_order.size(); i++)
+			{
+				for (NodeId successor : m_nodes[m_order[i]]->successors)
+				{
+					if (--remaining[successor] == 0)
+						m_order.push_back(successor);
+				}
+			}
+
+			if (m_order.size() != m_nodes.size())
+				return false;
+
+			m_stats.criticalPath.reserve(m_nodes.size());
+			m_isPrepared = true;
+
+			return true;
+		}
+
+		void runNode(NodeId id)
+		{
+			Node& node = *m_nodes[id];
+
+			node.start = Clock::now();
+
+			try
+			{
+				node.function();
+			}
+			catch (...)
+			{
+				if (!m_hasException.exchange(true, std::memory_order_relaxed))
+					m_exception = std::current_exception();
+			}
+
+			node.end = Clock::now();
+
+			for (NodeId successor : node.successors)
+			{
+				if (m_nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					m_pool->execute(&m_nodes[successor]->task);
+			}
+
+			// Nothing may touch the graph after this, since run() may return right away.
+			m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		void computeStats(Clock::time_point runEnd)
+		{
+			m_stats.wallTime = runEnd - m_runStart;
+			m_stats.workTime = std::chrono::nanoseconds(0);
+			m_stats.criticalPathTime = std::chrono::nanoseconds(0);
+			m_stats.criticalPath.clear();
+
+			// Longest chain of durations from each node to the end of the graph, in reverse topological order.
+			for (auto it = m_order.rbegin(); it != m_order.rend(); ++it)
+			{
+				Node& node = *m_nodes[*it];
+				std::chrono::nanoseconds longestSuccessor(0);
+
+				for (NodeId successor : node.successors)
+					longestSuccessor = std::max(longestSuccessor, m_nodes[successor]->longestPath);
+
+				node.longestPath = (node.end - node.start) + longestSuccessor;
+				m_stats.workTime += node.end - node.start;
+			}
+
+			const std::vector<NodeId>* candidates = &m_roots;
+
+			while (!candidates->empty())
+			{
+				NodeId next = candidates->front();
+
+				for (NodeId candidate : *candidates)
+				{
+					if (m_nodes[candidate]->longestPath > m_nodes[next]->longestPath)
+						next = candidate;
+				}
+
+				if (m_stats.criticalPath.empty())
+					m_stats.criticalPathTime = m_nodes[next]->longestPath;
+
+				m_stats.criticalPath.push_back(next);
+				candidates = &m_nodes[next]->successors;
+			}
+		}
+
+
+		std::vector<Scope<Node>> m_nodes;
+		std::vector<NodeId> m_roots;
+		std::vector<NodeId> m_order;
+		bool m_isPrepared = true;
+
+		ThreadPool* m_pool = nullptr;
+		std::atomic<std::size_t> m_remaining = 0;
+		std::atomic<bool> m_hasException = false;
+		std::exception_ptr m_exception;
+		Clock::time_point m_runStart;
+		RunStats m_stats{};
+	};
+
+}
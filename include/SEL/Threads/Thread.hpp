@@ -2,7 +2,11 @@
 
 #include "SEL/Utilities/NonCopyable.hpp"
 
+#include "SEL/Threads/Affinity.hpp"
+
+#include <string>
 #include <thread>
+#include <vector>
 
 
 namespace sel {
@@ -102,10 +106,55 @@ namespace sel {
 		}
 
 
+		/// @brief Restricts the thread to the given logical CPUs.
+		/// 
+		/// Only supported on Linux. False is also returned if the thread is not running.
+		/// 
+		/// @param cpus are the identifiers of the logical CPUs the thread may run on.
+		/// 
+		/// @return The value indicating if the affinity could be set.
+		/// 
+		bool setAffinity(const std::vector<unsigned int>& cpus)
+		{
+			return m_thread.joinable() && utils::setNativeAffinity(m_thread.native_handle(), cpus);
+		}
+
+		/// @brief Names the thread so that tools like top, perf or debuggers can show it.
+		/// 
+		/// Only supported on Linux, where the name is truncated to 15 characters. False is also returned if the thread is not running.
+		/// 
+		/// @param name is the name of the thread.
+		/// 
+		/// @return The value indicating if the name could be set.
+		/// 
+		bool setName(const std::string& name)
+		{
+			return m_thread.joinable() && utils::setNativeName(m_thread.native_handle(), name);
+		}
+
+		/// @brief Sets the scheduling policy and priority of the thread.
+		/// 
+		/// Only supported on Linux. Real-time policies usually require privileges. False is also returned if the thread is not running.
+		/// 
+		/// @param policy is the scheduling policy, such as SCHED_OTHER, SCHED_FIFO or SCHED_RR.
+		/// @param priority is the static priority, which must be 0 for SCHED_OTHER.
+		/// 
+		/// @return The value indicating if the scheduling could be set.
+		/// 
+		bool setScheduling(int policy, int priority)
+		{
+			return m_thread.joinable() && utils::setNativeScheduling(m_thread.native_handle(), policy, priority);
+		}
+
+
 		/// @return The thread's state.
 		///
 		State getState() const { return m_state; }
 
+		/// @return The native handle of the thread, for platform-specific controls.
+		///
+		std::thread::native_handle_type getNativeHandle() { return m_thread.native_handle(); }
+
 
 		/// @brief Swaps two Thread objects.
 		/// 
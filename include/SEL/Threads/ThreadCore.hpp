@@ -1,5 +1,9 @@
 #pragma once
 
+#include "SEL/Utilities/CachePadded.hpp"
+
+#include <atomic>
+#include <cstddef>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
@@ -15,6 +19,31 @@ namespace sel {
 
 	using WriteLock = std::unique_lock<Mutex>;
 
+	/// @brief Shared lock of any mutex type, such as FutexMutex.
+	/// 
+	template <class Lockable>
+	using BasicReadLock = std::shared_lock<Lockable>;
+
+	/// @brief Exclusive lock of any mutex type, such as FutexMutex or SeqLock.
+	/// 
+	template <class Lockable>
+	using BasicWriteLock = std::unique_lock<Lockable>;
+
+
+	namespace utils {
+
+		/// Number of the calling thread, given on first use. Consecutive threads get consecutive numbers,
+		/// which spreads them over per-thread slots such as the shards of a ShardedCounter.
+		inline std::size_t getThreadIndex()
+		{
+			static std::atomic<std::size_t> nextIndex = 0;
+			static thread_local std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+
+			return index;
+		}
+
+	}
+
 
 	/// @brief Blocks the thread until the given condition is fulfilled.
 	///
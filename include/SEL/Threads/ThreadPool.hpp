@@ -0,0 +1,405 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/Heartbeat.hpp"
+#include "SEL/Threads/WorkStealingDeque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Unit of work that can be executed by a ThreadPool.
+	///
+	/// The pool never deletes a task: execute() is responsible for the lifetime of the object.
+	/// This allows tasks to live on the stack or inside other objects when their owner waits for them.
+	///
+	class PoolTask
+	{
+	public:
+
+		virtual ~PoolTask() = default;
+
+		/// @brief Runs the task.
+		///
+		virtual void execute() = 0;
+	};
+
+
+	/// @brief Runs tasks on a fixed set of threads that steal work from each other.
+	///
+	/// Each worker owns a WorkStealingDeque. Tasks submitted from a worker go to its own deque,
+	/// tasks submitted from any other thread go to a shared queue.
+	/// Idle workers steal from the others and park once no work can be found.
+	///
+	class ThreadPool : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor that creates the worker threads.
+		///
+		/// @param threadCount is the number of workers. If 0, one worker per hardware thread is created.
+		///
+		explicit ThreadPool(std::size_t threadCount = 0)
+		{
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+			m_workers.reserve(threadCount);
+
+			for (std::size_t i = 0; i < threadCount; i++)
+				m_workers.push_back(createScope<Worker>(this, i));
+
+			for (auto& worker : m_workers)
+				worker->thread.run(&ThreadPool::workerLoop, this, worker.get());
+		}
+
+		/// @brief Destructor that lets the workers finish every queued task before joining them.
+		///
+		~ThreadPool()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_idleMutex);
+				m_isStopping.store(true, std::memory_order_relaxed);
+			}
+
+			m_idleCondition.notify_all();
+
+			for (auto& worker : m_workers)
+				worker->thread.join();
+		}
+
+
+		/// @brief Queues a callable and returns a future to its result.
+		///
+		/// Exceptions thrown by the callable are stored in the future.
+		///
+		/// @tparam Fn is a callable type.
+		/// @tparam ...Args are the argument types.
+		/// @param function is the callable object.
+		/// @param ...args are the arguments that are needed to call the object.
+		///
+		/// @return The future that will hold the value returned by the callable.
+		///
+		template <class Fn, class ...Args>
+		auto submit(Fn&& function, Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<Fn>, std::decay_t<Args>...>>
+		{
+			using R = std::invoke_result_t<std::decay_t<Fn>, std::decay_t<Args>...>;
+
+			auto* task = new FutureTask<R>(
+				[function = std::forward<Fn>(function), arguments = std::make_tuple(std::forward<Args>(args)...)]() mutable
+				{
+					return std::apply(function, arguments);
+				}
+			);
+
+			std::future<R> future = task->getFuture();
+			execute(task);
+
+			return future;
+		}
+
+		/// @brief Queues a task without taking its ownership.
+		///
+		/// The task must stay alive until its execute() method has been called.
+		///
+		/// @param task is the task being queued.
+		///
+		void execute(PoolTask* task)
+		{
+			Worker* worker = s_currentWorker;
+
+			if (worker && worker->pool == this)
+				worker->deque.push(task);
+			else
+			{
+				std::unique_lock<std::mutex> lock(m_injectionMutex);
+				m_injection.push_back(task);
+			}
+
+			wakeWorker();
+		}
+
+		/// @brief Queues a task without taking its ownership, behind the work already queued.
+		///
+		/// Unlike execute(), the task always goes to the shared queue, even when called from a worker.
+		/// The calling worker thus runs the tasks of its own deque first, which is what yielding needs.
+		///
+		/// @param task is the task being queued.
+		///
+		void post(PoolTask* task)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_injectionMutex);
+				m_injection.push_back(task);
+			}
+
+			wakeWorker();
+		}
+
+		/// @brief Runs one queued task on the calling thread, if any.
+		///
+		/// Threads waiting for tasks of the pool should call this method instead of blocking
+		/// so that nested waits cannot deadlock the pool.
+		///
+		/// @return The value indicating if a task was run.
+		///
+		bool runPendingTask()
+		{
+			Worker* worker = s_currentWorker;
+			PoolTask* task = findTask(worker && worker->pool == this ? worker : nullptr);
+
+			if (!task)
+				return false;
+
+			task->execute();
+			return true;
+		}
+
+
+		/// @brief Makes a worker beat a heartbeat before each task and mark it idle before parking.
+		///
+		/// @param index is the index of the worker.
+		/// @param heartbeat is the heartbeat, which must outlive its use by the pool. nullptr stops beating.
+		///
+		void setHeartbeat(std::size_t index, Heartbeat* heartbeat)
+		{
+			m_workers[index]->heartbeat.store(heartbeat, std::memory_order_release);
+		}
+
+
+		/// @return The number of worker threads.
+		///
+		std::size_t getThreadCount() const { return m_workers.size(); }
+
+		/// @return The pool shared by the library's parallel algorithms. It is created on first use
+		/// with one worker per hardware thread.
+		///
+		static ThreadPool& getShared()
+		{
+			static ThreadPool pool;
+
+			return pool;
+		}
+
+		/// @return The index of the calling worker within its pool, or -1 if the calling thread is not a worker of this pool.
+		///
+		int getWorkerIndex() const
+		{
+			Worker* worker = s_currentWorker;
+
+			return worker && worker->pool == this ? static_cast<int>(worker->index) : -1;
+		}
+
+
+	private:
+
+		template <class R>
+		class FutureTask : public PoolTask
+		{
+		public:
+
+			template <class Fn>
+			explicit FutureTask(Fn&& function)
+				: m_task(std::forward<Fn>(function)) {}
+
+			std::future<R> getFuture() { return m_task.get_future(); }
+
+			void execute() override
+			{
+				m_task();
+				delete this;
+			}
+
+		private:
+
+			std::packaged_task<R()> m_task;
+		};
+
+		struct Worker
+		{
+			Worker(ThreadPool* owner, std::size_t workerIndex)
+				: pool(owner), index(workerIndex), seed(static_cast<std::uint32_t>(workerIndex * 2654435761u + 1)) {}
+
+			ThreadPool* pool;
+			std::size_t index;
+			std::uint32_t seed;
+			std::atomic<Heartbeat*> heartbeat = nullptr;
+			WorkStealingDeque<PoolTask*> deque;
+			Thread thread;
+		};
+
+
+		void workerLoop(Worker* worker)
+		{
+			s_currentWorker = worker;
+
+			while (true)
+			{
+				PoolTask* task = findTask(worker);
+
+				// Work often arrives in bursts, so look again for a while before parking.
+				for (unsigned int i = 0; !task && i < s_spinCount; i++)
+				{
+					std::this_thread::yield();
+					task = findTask(worker);
+				}
+
+				Heartbeat* heartbeat = worker->heartbeat.load(std::memory_order_acquire);
+
+				if (task)
+				{
+					if (heartbeat)
+						heartbeat->beat();
+
+					task->execute();
+				}
+				else
+				{
+					if (heartbeat)
+						heartbeat->setIdle();
+
+					if (!park())
+						break;
+				}
+			}
+
+			s_currentWorker = nullptr;
+		}
+
+		PoolTask* findTask(Worker* worker)
+		{
+			PoolTask* task = nullptr;
+
+			if (worker && worker->deque.pop(task))
+				return task;
+
+			{
+				std::unique_lock<std::mutex> lock(m_injectionMutex);
+
+				if (!m_injection.empty())
+				{
+					task = m_injection.front();
+					m_injection.pop_front();
+					return task;
+				}
+			}
+
+			// Steal from the other workers, starting at a pseudo-random victim.
+			std::size_t count = m_workers.size();
+			std::size_t start = worker ? nextRandom(*worker) % count : 0;
+
+			for (std::size_t i = 0; i < count; i++)
+			{
+				Worker* victim = m_workers[(start + i) % count].get();
+
+				if (victim != worker && victim->deque.steal(task))
+					return task;
+			}
+
+			return nullptr;
+		}
+
+		bool hasWork()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_injectionMutex);
+
+				if (!m_injection.empty())
+					return true;
+			}
+
+			for (auto& worker : m_workers)
+				if (!worker->deque.isEmpty())
+					return true;
+
+			return false;
+		}
+
+		bool park()
+		{
+			std::unique_lock<std::mutex> lock(m_idleMutex);
+
+			m_sleepingCount.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			// Pairs with the fence in wakeWorker(): either the submitter sees this worker sleeping
+			// or this worker sees the submitted task.
+			if (hasWork())
+			{
+				m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			if (m_isStopping.load(std::memory_order_relaxed))
+			{
+				m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			std::uint64_t token = m_wakeToken;
+			m_idleCondition.wait(lock, [&] { return m_wakeToken != token || m_isStopping.load(std::memory_order_relaxed); });
+			m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+
+			return true;
+		}
+
+		void wakeWorker()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (m_sleepingCount.load(std::memory_order_relaxed) == 0)
+				return;
+
+			{
+				std::unique_lock<std::mutex> lock(m_idleMutex);
+				m_wakeToken++;
+			}
+
+			m_idleCondition.notify_one();
+		}
+
+		static std::uint32_t nextRandom(Worker& worker)
+		{
+			// xorshift32
+			std::uint32_t x = worker.seed;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			worker.seed = x;
+
+			return x;
+		}
+
+
+		/// Number of failed searches for work a worker makes before parking.
+		static constexpr unsigned int s_spinCount = 64;
+
+		inline static thread_local Worker* s_currentWorker = nullptr;
+
+		std::vector<Scope<Worker>> m_workers;
+
+		std::mutex m_injectionMutex;
+		std::deque<PoolTask*> m_injection;
+
+		std::mutex m_idleMutex;
+		std::condition_variable m_idleCondition;
+		std::uint64_t m_wakeToken = 0;
+		std::atomic<std::size_t> m_sleepingCount = 0;
+		std::atomic<bool> m_isStopping = false;
+	};
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/CachePadded.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace sel {
+
+	/// @brief Lock-free exchange of whole states from exactly one writer thread to exactly one reader thread.
+	///
+	/// Three buffers rotate between the writer, the reader and a middle slot holding the latest published
+	/// one. Publishing and fetching each swap a buffer index with the middle slot, so neither side ever
+	/// blocks nor copies the payload, and the reader always gets the latest complete state.
+	/// States published before the reader fetched them are skipped.
+	///
+	/// Buffers are reused rather than cleared: the writer gets back a buffer holding an older state,
+	/// which it must overwrite entirely, and which keeps its allocations, such as a vector capacity.
+	///
+	/// @tparam T is the type of the exchanged state.
+	///
+	template <class T>
+	class TripleBuffer : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param value is the initial state of the three buffers.
+		///
+		explicit TripleBuffer(const T& value = T())
+			: m_buffers{ CachePadded<T>(value), CachePadded<T>(value), CachePadded<T>(value) } {}
+
+
+		/// @return The buffer being written. Must only be called by the writer.
+		///
+		T& getWriteBuffer() { return *m_buffers[m_writeIndex]; }
+
+		/// @brief Publishes the write buffer as the latest state and takes another one. Must only be called by the writer.
+		///
+		void publish()
+		{
+			// Releases the writes of the state, and acquires the reads the reader made of the buffer it gave back.
+			m_writeIndex = m_middle.exchange(m_writeIndex | s_newFlag, std::memory_order_acq_rel) & s_indexMask;
+		}
+
+
+		/// @brief Takes the latest published state, if any was published since the last call. Must only be called by the reader.
+		///
+		/// @return The value indicating if the read buffer changed.
+		///
+		bool fetch()
+		{
+			if (!(m_middle.load(std::memory_order_relaxed) & s_newFlag))
+				return false;
+
+			m_readIndex = m_middle.exchange(m_readIndex, std::memory_order_acq_rel) & s_indexMask;
+
+			return true;
+		}
+
+		/// @return The buffer being read, which holds the state taken by the last fetch(). Must only be called by the reader.
+		///
+		T& getReadBuffer() { return *m_buffers[m_readIndex]; }
+
+		/// @return The value indicating if a state was published since the last fetch().
+		///
+		bool hasNew() const { return m_middle.load(std::memory_order_relaxed) & s_newFlag; }
+
+
+	private:
+
+		static constexpr std::uint8_t s_indexMask = 0b011;
+		/// Set in the middle index when it holds a state the reader has not fetched yet.
+		static constexpr std::uint8_t s_newFlag = 0b100;
+
+		CachePadded<T> m_buffers[3];
+		alignas(cacheLineSize) std::atomic<std::uint8_t> m_middle = 1;
+		alignas(cacheLineSize) std::uint8_t m_writeIndex = 0;
+		alignas(cacheLineSize) std::uint8_t m_readIndex = 2;
+	};
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+#include "SEL/Utilities/Reference.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+#include "SEL/Threads/Thread.hpp"
+#include "SEL/Threads/Heartbeat.hpp"
+#include "SEL/Threads/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Detects threads that stay stuck in a unit of work for too long.
+	///
+	/// Each monitored thread writes a Heartbeat owned by the watchdog. A thread owned by the watchdog
+	/// checks every heartbeat periodically and calls the user callback once per stall, when a busy
+	/// heartbeat has not changed for longer than its deadline. Stalls are thus detected with a delay
+	/// of up to one check interval.
+	///
+	class Watchdog : public NonCopyable, public NonMovable
+	{
+	public:
+
+		/// @brief Function called when a stall is detected, with the name of the heartbeat and the time since its last beat.
+		///
+		using Callback = std::function<void(const std::string&, std::chrono::nanoseconds)>;
+
+
+		/// @brief Constructor that starts the checking thread.
+		///
+		/// @param callback is the function called from the checking thread for every stall.
+		/// @param checkInterval is the time between two checks.
+		///
+		explicit Watchdog(Callback callback, std::chrono::nanoseconds checkInterval = std::chrono::milliseconds(10))
+			: m_callback(std::move(callback)), m_checkInterval(checkInterval)
+		{
+			m_thread.run(&Watchdog::checkLoop, this);
+		}
+
+		/// @brief Destructor that stops the checking thread. Every heartbeat is destroyed, so no thread may still write one.
+		///
+		~Watchdog()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_isStopping = true;
+			}
+
+			m_condition.notify_one();
+			m_thread.join();
+		}
+
+
+		/// @brief Creates a heartbeat to be written by a thread.
+		///
+		/// @param name is the name given to the callback when the thread stalls.
+		/// @param deadline is how long the thread may stay busy without beating.
+		///
+		/// @return The heartbeat, which lives until it is removed or the watchdog is destroyed.
+		///
+		Heartbeat& add(std::string name, std::chrono::nanoseconds deadline)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_entries.push_back(createScope<Entry>(std::move(name), deadline));
+			return m_entries.back()->heartbeat;
+		}
+
+		/// @brief Stops monitoring and destroys a heartbeat. No thread may still write it.
+		///
+		/// @param heartbeat is the heartbeat returned by add().
+		///
+		/// @return The value indicating if the heartbeat belonged to this watchdog.
+		///
+		bool remove(Heartbeat& heartbeat)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			auto it = std::find_if(m_entries.begin(), m_entries.end(), [&heartbeat](const Scope<Entry>& entry) {
+				return &entry->heartbeat == &heartbeat;
+			});
+
+			if (it == m_entries.end())
+				return false;
+
+			m_entries.erase(it);
+			return true;
+		}
+
+		/// @brief Monitors a thread exposing setHeartbeat(), such as a LoopThread.
+		///
+		/// @tparam Watched is the type of the monitored thread.
+		/// @param watched is the monitored thread.
+		/// @param name is the name given to the callback when the thread stalls.
+		/// @param deadline is how long a repetition of the task may last.
+		///
+		/// @return The heartbeat given to the thread, or nullptr if the thread refused it.
+		///
+		template <class Watched>
+		Heartbeat* watch(Watched& watched, std::string name, std::chrono::nanoseconds deadline)
+		{
+			Heartbeat& heartbeat = add(std::move(name), deadline);
+
+			if (watched.setHeartbeat(&heartbeat))
+				return &heartbeat;
+
+			remove(heartbeat);
+			return nullptr;
+		}
+
+		/// @brief Monitors every worker of a pool.
+		///
+		/// The pool must be destroyed or its heartbeats reset before the watchdog is destroyed.
+		///
+		/// @param pool is the monitored pool.
+		/// @param name is the prefix of the names given to the callback, followed by the index of the stalled worker.
+		/// @param deadline is how long a task may last.
+		///
+		void watch(ThreadPool& pool, const std::string& name, std::chrono::nanoseconds deadline)
+		{
+			for (std::size_t i = 0; i < pool.getThreadCount(); i++)
+				pool.setHeartbeat(i, &add(name + std::to_string(i), deadline));
+		}
+
+
+		/// @return The number of heartbeats being monitored.
+		///
+		std::size_t getHeartbeatCount() const
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			return m_entries.size();
+		}
+
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		struct Entry
+		{
+			Entry(std::string entryName, std::chrono::nanoseconds entryDeadline)
+				: name(std::move(entryName)), deadline(entryDeadline), lastChange(Clock::now()) {}
+
+			Heartbeat heartbeat;
+			std::string name;
+			std::chrono::nanoseconds deadline;
+			std::uint64_t lastValue = Heartbeat::s_idleBit;
+			Clock::time_point lastChange;
+			bool hasFired = false;
+		};
+
+		struct Stall
+		{
+			std::string name;
+			std::chrono::nanoseconds duration;
+		};
+
+
+		void checkLoop()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			std::vector<Stall> stalls;
+
+			while (!m_isStopping)
+			{
+				m_condition.wait_for(lock, m_checkInterval, [this] { return m_isStopping; });
+
+				Clock::time_point now = Clock::now();
+
+				for (auto& entry : m_entries)
+				{
+					std::uint64_t value = entry->heartbeat.m_value.load(std::memory_order_relaxed);
+
+					if (value != entry->lastValue)
+					{
+						entry->lastValue = value;
+						entry->lastChange = now;
+						entry->hasFired = false;
+					}
+					else if (!(value & Heartbeat::s_idleBit) && !entry->hasFired && now - entry->lastChange > entry->deadline)
+					{
+						entry->hasFired = true;
+						stalls.push_back({ entry->name, now - entry->lastChange });
+					}
+				}
+
+				if (stalls.empty())
+					continue;
+
+				// The callback may add or remove heartbeats, so it is called with the mutex unlocked.
+				lock.unlock();
+
+				for (const Stall& stall : stalls)
+					m_callback(stall.name, stall.duration);
+
+				stalls.clear();
+				lock.lock();
+			}
+		}
+
+
+		Callback m_callback;
+		std::chrono::nanoseconds m_checkInterval;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::vector<Scope<Entry>> m_entries;
+		bool m_isStopping = false;
+
+		Thread m_thread;
+	};
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+#include "SEL/Utilities/NonMovable.hpp"
+
+#include "SEL/Threads/ThreadCore.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+namespace sel {
+
+	/// @brief Chase-Lev double-ended queue used to distribute work between threads.
+	///
+	/// Only the thread owning the deque may call push() and pop(), which work at the bottom end.
+	/// Any other thread may call steal(), which takes elements from the top end.
+	/// The storage grows when full. Replaced arrays are kept until the deque is destroyed,
+	/// since a thief may still be reading them.
+	///
+	/// @tparam T is the type of the stored elements. It must be trivially copyable, typically a pointer.
+	///
+	template <class T>
+	class WorkStealingDeque : public NonCopyable, public NonMovable
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque elements must be trivially copyable.");
+
+	public:
+
+		/// @brief Constructor.
+		///
+		/// @param capacity is the initial number of elements the deque can hold. It must be a power of two.
+		///
+		explicit WorkStealingDeque(std::int64_t capacity = 256)
+			: m_top(0), m_bottom(0), m_array(new Array(capacity)) {}
+
+		/// @brief Destructor that releases every array used by the deque.
+		///
+		~WorkStealingDeque()
+		{
+			for (Array* array : m_retired)
+				delete array;
+
+			delete m_array.load(std::memory_order_relaxed);
+		}
+
+
+		/// @brief Adds an element at the bottom of the deque. Must only be called by the owner.
+		///
+		/// @param element is the element being pushed.
+		///
+		void push(T element)
+		{
+			std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			std::int64_t top = m_top.load(std::memory_order_acquire);
+			Array* array = m_array.load(std::memory_order_relaxed);
+
+			if (bottom - top > array->capacity - 1)
+				array = grow(array, top, bottom);
+
+			array->put(bottom, element);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		/// @brief Removes the element at the bottom of the deque. Must only be called by the owner.
+		///
+		/// @param element is where the removed element is written.
+		///
+		/// @return The value indicating if an element could be removed.
+		///
+		bool pop(T& element)
+		{
+			std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			Array* array = m_array.load(std::memory_order_relaxed);
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			element = array->get(bottom);
+
+			if (top == bottom)
+			{
+				// Last element, race against thieves for it.
+				bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return won;
+			}
+
+			return true;
+		}
+
+		/// @brief Removes the element at the top of the deque. May be called by any thread.
+		///
+		/// False is also returned when another thread won the race for the element.
+		///
+		/// @param element is where the removed element is written.
+		///
+		/// @return The value indicating if an element could be removed.
+		///
+		bool steal(T& element)
+		{
+			std::int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+				return false;
+
+			Array* array = m_array.load(std::memory_order_acquire);
+			T stolen = array->get(top);
+
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return false;
+
+			element = stolen;
+			return true;
+		}
+
+
+		/// @return The value indicating if the deque seemed empty when called.
+		///
+		bool isEmpty() const
+		{
+			std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+			std::int64_t top = m_top.load(std::memory_order_acquire);
+
+			return top >= bottom;
+		}
+
+
+	private:
+
+		struct Array
+		{
+			explicit Array(std::int64_t size)
+				: capacity(size), mask(size - 1), elements(new std::atomic<T>[size]) {}
+
+			~Array()
+			{
+				delete[] elements;
+			}
+
+			T get(std::int64_t index) const
+			{
+				return elements[index & mask].load(std::memory_order_relaxed);
+			}
+
+			void put(std::int64_t index, T element)
+			{
+				elements[index & mask].store(element, std::memory_order_relaxed);
+			}
+
+			std::int64_t capacity;
+			std::int64_t mask;
+			std::atomic<T>* elements;
+		};
+
+		Array* grow(Array* array, std::int64_t top, std::int64_t bottom)
+		{
+			Array* bigger = new Array(array->capacity * 2);
+
+			for (std::int64_t i = top; i < bottom; i++)
+				bigger->put(i, array->get(i));
+
+			m_retired.push_back(array);
+			m_array.store(bigger, std::memory_order_release);
+
+			return bigger;
+		}
+
+
+		alignas(cacheLineSize) std::atomic<std::int64_t> m_top;
+		alignas(cacheLineSize) std::atomic<std::int64_t> m_bottom;
+		std::atomic<Array*> m_array;
+		std::vector<Array*> m_retired;
+	};
+
+}
@@ -1,7 +1,9 @@
 // Include all Utilities headers
 
+#include "SEL/Utilities/CachePadded.hpp"
 #include "SEL/Utilities/Casts.hpp"
 #include "SEL/Utilities/Container.hpp"
+#include "SEL/Utilities/InplaceFunction.hpp"
 #include "SEL/Utilities/NonCopyable.hpp"
 #include "SEL/Utilities/NonMovable.hpp"
 #include "SEL/Utilities/Reference.hpp"
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace sel {
+
+	/// @brief Size in bytes of a cache line.
+	///
+	/// Data written by different threads is kept this far apart to avoid false sharing.
+	///
+	inline constexpr std::size_t cacheLineSize = 64;
+
+
+	/// @brief Stores a value alone on its own cache lines.
+	///
+	/// Two threads writing to values that share a cache line keep stealing the line from each other even though
+	/// they never touch the same data. This is false sharing. Padding each value to a whole number of cache lines avoids it.
+	///
+	/// @tparam T is the type of the stored value.
+	///
+	template <class T>
+	class alignas(cacheLineSize) CachePadded
+	{
+	public:
+
+		/// @brief Default constructor. Value-initializes the value.
+		///
+		/// It is not explicit, so that arrays of padded values can be value-initialized with {}.
+		///
+		CachePadded()
+			: m_value() {}
+
+		/// @brief Constructor that constructs the value in place.
+		///
+		/// It is explicit so that values do not silently convert to padded ones, and it leaves
+		/// the copy of a CachePadded to the copy constructor.
+		///
+		/// @tparam ...Args are the types of the arguments for the value constructor.
+		/// @param ...args are the arguments for the value constructor.
+		///
+		template <class ...Args, class = std::enable_if_t<(sizeof...(Args) > 0) && !(sizeof...(Args) == 1 && (std::is_same_v<std::remove_cv_t<std::remove_reference_t<Args>>, CachePadded> && ...))>>
+		explicit CachePadded(Args&&... args)
+			: m_value(std::forward<Args>(args)...) {}
+
+
+		/// @return The stored value.
+		///
+		T& get() { return m_value; }
+
+		/// @return The stored value.
+		///
+		const T& get() const { return m_value; }
+
+		T& operator*() { return m_value; }
+
+		const T& operator*() const { return m_value; }
+
+		T* operator->() { return &m_value; }
+
+		const T* operator->() const { return &m_value; }
+
+
+	private:
+
+		T m_value;
+	};
+
+}
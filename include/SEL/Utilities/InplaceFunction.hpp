@@ -0,0 +1,190 @@
+#pragma once
+
+#include "SEL/Utilities/NonCopyable.hpp"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace sel {
+
+	template <class Signature, std::size_t Capacity = 64>
+	class InplaceFunction;
+
+	/// @brief Move-only function wrapper that stores its callable inside the object itself.
+	///
+	/// Unlike std::function, no heap allocation is ever made: callables that do not fit in the
+	/// given capacity are rejected at compile time. Calling an empty InplaceFunction is undefined behavior.
+	///
+	/// @tparam R is the return type of the function.
+	/// @tparam ...Args are the argument types of the function.
+	/// @tparam Capacity is the size in bytes of the storage for the callable.
+	///
+	template <class R, class ...Args, std::size_t Capacity>
+	class InplaceFunction<R(Args...), Capacity> : public NonCopyable
+	{
+	public:
+
+		/// @brief Default constructor. The function is empty.
+		///
+		InplaceFunction() noexcept = default;
+
+		/// @brief Constructor making an empty function.
+		///
+		InplaceFunction(std::nullptr_t) noexcept {}
+
+		/// @brief Constructor that stores a callable.
+		///
+		/// @tparam Fn is a callable type. It must fit in Capacity bytes and be nothrow move constructible.
+		/// @param function is the callable object.
+		///
+		template <class Fn, class = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, InplaceFunction>>>
+		InplaceFunction(Fn&& function)
+		{
+			using Callable = std::decay_t<Fn>;
+
+			static_assert(std::is_invocable_r_v<R, Callable&, Args...>, "The callable does not match the signature of the InplaceFunction.");
+			static_assert(sizeof(Callable) <= Capacity, "The callable does not fit in the InplaceFunction, increase its capacity.");
+			static_assert(alignof(Callable) <= alignof(std::max_align_t), "The callable is over-aligned for the InplaceFunction.");
+			static_assert(std::is_nothrow_move_constructible_v<Callable>, "The callable must be nothrow move constructible.");
+
+			::new (static_cast<void*>(&m_storage)) Callable(std::forward<Fn>(function));
+			m_invoke = &invoke<Callable>;
+			m_manage = &manage<Callable>;
+		}
+
+		/// @brief Move constructor.
+		///
+		/// @param other is the InplaceFunction object being moved. It is left empty.
+		///
+		InplaceFunction(InplaceFunction&& other) noexcept
+		{
+			moveFrom(other);
+		}
+
+		/// @brief Destructor that destroys the stored callable.
+		///
+		~InplaceFunction()
+		{
+			reset();
+		}
+
+
+		/// @brief Move assignment operator.
+		///
+		/// @param other is the InplaceFunction object being moved. It is left empty.
+		///
+		/// @return The assigned InplaceFunction object.
+		///
+		InplaceFunction& operator=(InplaceFunction&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				moveFrom(other);
+			}
+
+			return *this;
+		}
+
+		/// @brief Assignment operator that empties the function.
+		///
+		/// @return The assigned InplaceFunction object.
+		///
+		InplaceFunction& operator=(std::nullptr_t) noexcept
+		{
+			reset();
+			return *this;
+		}
+
+		/// @brief Calls the stored callable.
+		///
+		/// @param ...args are the arguments given to the callable.
+		///
+		/// @return The value returned by the callable.
+		///
+		R operator()(Args... args) const
+		{
+			return m_invoke(&m_storage, std::forward<Args>(args)...);
+		}
+
+		/// @return The value indicating if a callable is stored.
+		///
+		explicit operator bool() const noexcept { return m_invoke != nullptr; }
+
+
+		/// @brief Swaps two InplaceFunction objects.
+		///
+		/// @param other is the other InplaceFunction object being swapped.
+		///
+		void swap(InplaceFunction& other) noexcept
+		{
+			if (this != &other)
+			{
+				InplaceFunction temp(std::move(other));
+				other = std::move(*this);
+				*this = std::move(temp);
+			}
+		}
+
+
+	private:
+
+		enum class Operation
+		{
+			Move,
+			Destroy,
+		};
+
+		using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+
+		template <class Callable>
+		static R invoke(void* storage, Args&&... args)
+		{
+			return (*std::launder(static_cast<Callable*>(storage)))(std::forward<Args>(args)...);
+		}
+
+		template <class Callable>
+		static void manage(Operation operation, void* destination, void* source)
+		{
+			Callable* callable = std::launder(static_cast<Callable*>(source));
+
+			if (operation == Operation::Move)
+				::new (destination) Callable(std::move(*callable));
+
+			callable->~Callable();
+		}
+
+		void moveFrom(InplaceFunction& other) noexcept
+		{
+			if (other.m_manage)
+			{
+				other.m_manage(Operation::Move, &m_storage, &other.m_storage);
+
+				m_invoke = other.m_invoke;
+				m_manage = other.m_manage;
+				other.m_invoke = nullptr;
+				other.m_manage = nullptr;
+			}
+		}
+
+		void reset() noexcept
+		{
+			if (m_manage)
+			{
+				m_manage(Operation::Destroy, nullptr, &m_storage);
+
+				m_invoke = nullptr;
+				m_manage = nullptr;
+			}
+		}
+
+
+		mutable Storage m_storage;
+		R (*m_invoke)(void*, Args&&...) = nullptr;
+		void (*m_manage)(Operation, void*, void*) = nullptr;
+	};
+
+}